@@ -0,0 +1,291 @@
+#ifndef _CONCURRENT_TRVL_OPTNS_H
+#define _CONCURRENT_TRVL_OPTNS_H
+
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+#include "TravelOptions.h"
+#include "FrontierFile.h"
+
+/**
+ * ConcurrentTravelOptions:  one frontier shared by many query threads and updated by ingest
+ *   threads, without a lock around every read.
+ *
+ * Writers update a private TravelOptions (the master) under a writer mutex and then publish an
+ *   immutable Snapshot of it:  a contiguous copy of the options, a version number and the
+ *   sorted / pareto flags.  Publishing is one atomic pointer swap, so a reader sees either the
+ *   old version or the new one, never a list in the middle of an update.
+ *
+ * Readers never block:  a ReadGuard pins the current snapshot for as long as it lives, and reads
+ *   it through a MappedOptions view (size, to_vec, split_sorted_pareto, range and the budget /
+ *   time lookups, all without copying).
+ *
+ * Reclamation is epoch based.  A reader announces the global epoch in one of SLOTS slots before
+ *   loading the snapshot pointer.  A writer that replaces a snapshot retires it with the epoch E
+ *   current at the swap and advances the epoch; a retired snapshot is freed (by a later writer)
+ *   once no slot holds an epoch <= E, i.e., once every reader that could have loaded it is done.
+ *   Readers only wait if more than SLOTS of them are inside a ReadGuard at the same moment.
+ *
+ * Writes pay for the snapshot:  every publish copies the whole frontier, O(n).  The single-option
+ *   operations (insert_sorted, insert_pareto_sorted, prune_sorted, clear) are group-committed:  a
+ *   writer queues its operation and then takes the writer lock; whoever gets the lock applies every
+ *   queued operation, in queue order, and publishes once for all of them.  So k writers arriving
+ *   while a publish is under way share the next O(n) copy instead of making k of them.  update()
+ *   batches explicitly:  any number of changes in one call, one publish.
+ */
+class ConcurrentTravelOptions{
+
+  public:
+    static const int SLOTS = 128;
+
+    /* an immutable version of the frontier */
+    class Snapshot {
+        friend class ConcurrentTravelOptions;
+
+        std::vector<double> _rec;   // price, time, price, time, ...
+        unsigned _flags;
+        uint64_t _version;
+
+      public:
+        uint64_t version() const { return _version; }
+
+        MappedOptions view() const {
+          return MappedOptions(_rec.data(), _rec.size() / 2, _flags);
+        }
+    };
+
+    /**
+     * ReadGuard:  pins the current snapshot (RAII).  Keep it short lived; while it exists the
+     *   snapshot it holds (and anything retired after it) cannot be freed.
+     */
+    class ReadGuard {
+        std::atomic<uint64_t> *_slot;
+        const Snapshot *_snap;
+
+      public:
+        explicit ReadGuard(const ConcurrentTravelOptions &c) {
+          _slot = c.enter();
+          _snap = c._current.load();
+        }
+
+        ~ReadGuard() {
+          _slot->store(0, std::memory_order_release);
+        }
+
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard & operator=(const ReadGuard &) = delete;
+
+        const Snapshot & snapshot() const { return *_snap; }
+        MappedOptions view() const { return _snap->view(); }
+    };
+
+  private:
+    // one reader slot per cache line:  0 = free, otherwise the epoch the reader entered in
+    struct Slot {
+        std::atomic<uint64_t> epoch;
+        char pad[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    TravelOptions _master;
+    std::mutex _write;
+    uint64_t _version;
+    std::atomic<const Snapshot *> _current;
+    std::atomic<uint64_t> _epoch;
+    mutable Slot _slots[SLOTS];
+    std::vector<std::pair<const Snapshot *, uint64_t>> _retired;   // (snapshot, epoch it was retired in)
+    std::vector<std::pair<double, double>> _buf;                    // publish scratch
+
+    // a queued single-option operation (see apply)
+    struct Request {
+        std::function<bool(TravelOptions &)> op;
+        bool result;
+        bool done;   // written and read under _write
+    };
+    std::mutex _queue;
+    std::vector<Request *> _pending;
+
+    ConcurrentTravelOptions(const ConcurrentTravelOptions &) = delete;
+    ConcurrentTravelOptions & operator=(const ConcurrentTravelOptions &) = delete;
+
+    /**
+     * func: enter
+     * desc: claims a free reader slot and announces the current epoch in it.  Threads start
+     *       their search at different slots so they rarely contend for one.
+     */
+    std::atomic<uint64_t> * enter() const {
+      static thread_local unsigned hint = (unsigned)std::hash<std::thread::id>()(std::this_thread::get_id());
+
+      for(unsigned k = hint; ; k++) {
+        std::atomic<uint64_t> &slot = _slots[k % SLOTS].epoch;
+        uint64_t expected = 0;
+        if(slot.load(std::memory_order_relaxed) == 0 && slot.compare_exchange_strong(expected, _epoch.load())) {
+          hint = k;
+          return &slot;
+        }
+      }
+    }
+
+    /**
+     * func: publish
+     * desc: (writer lock held) snapshots the master, swaps it in and retires the old snapshot;
+     *       then frees whatever retired snapshot no reader can still hold.
+     */
+    void publish() {
+      Snapshot *s = new Snapshot();
+
+      _master.to_vec(_buf);
+      s->_rec.resize(2 * _buf.size());
+      for(size_t i=0; i<_buf.size(); i++) {
+        s->_rec[2*i] = _buf[i].first;
+        s->_rec[2*i+1] = _buf[i].second;
+      }
+      s->_flags = (_master.is_sorted() ? MappedOptions::SORTED : 0) |
+                  (_master.is_pareto() ? MappedOptions::PARETO : 0) |
+                  (_master.is_pareto_sorted() ? MappedOptions::PARETO_SORTED : 0);
+      s->_version = ++_version;
+
+      const Snapshot *old = _current.exchange(s);
+      _retired.push_back(std::make_pair(old, _epoch.fetch_add(1)));
+
+      uint64_t oldest = UINT64_MAX;
+      for(int k=0; k<SLOTS; k++) {
+        uint64_t e = _slots[k].epoch.load();
+        if(e != 0 && e < oldest)
+          oldest = e;
+      }
+      size_t kept = 0;
+      for(size_t i=0; i<_retired.size(); i++) {
+        if(_retired[i].second < oldest)
+          delete _retired[i].first;
+        else
+          _retired[kept++] = _retired[i];
+      }
+      _retired.resize(kept);
+    }
+
+    /**
+     * func: apply
+     * desc: group commit of one operation:  queues it, takes the writer lock and, unless an earlier
+     *       lock holder already did, applies every queued operation and publishes once.
+     * returns: what op returned on the master
+     */
+    bool apply(std::function<bool(TravelOptions &)> op) {
+      Request r = { op, false, false };
+      {
+        std::lock_guard<std::mutex> q(_queue);
+        _pending.push_back(&r);
+      }
+
+      std::lock_guard<std::mutex> g(_write);
+      if(r.done)
+        return r.result;
+      std::vector<Request *> batch;
+      {
+        std::lock_guard<std::mutex> q(_queue);
+        batch.swap(_pending);
+      }
+      for(size_t i=0; i<batch.size(); i++) {
+        batch[i]->result = batch[i]->op(_master);
+        batch[i]->done = true;
+      }
+      publish();
+      return r.result;
+    }
+
+  public:
+    ConcurrentTravelOptions() : _version(0), _epoch(1) {
+      for(int k=0; k<SLOTS; k++)
+        _slots[k].epoch.store(0);
+      Snapshot *s = new Snapshot();
+      s->_flags = MappedOptions::SORTED | MappedOptions::PARETO | MappedOptions::PARETO_SORTED;
+      s->_version = 0;
+      _current.store(s);
+    }
+
+    // no reader may still be inside a ReadGuard
+    ~ConcurrentTravelOptions() {
+      delete _current.load();
+      for(size_t i=0; i<_retired.size(); i++)
+        delete _retired[i].first;
+    }
+
+   /**
+   * func: update
+   * desc: runs f(master) under the writer lock, where master is the writers' private TravelOptions,
+   *       then publishes the result as one new version (so a batch of changes costs one snapshot).
+   * returns: whatever f returns
+   * RUNTIME:  f, plus O(n) to build the snapshot (once per call, however many changes f makes)
+   * status:  DONE
+   */
+    template <typename F>
+    auto update(F f) -> decltype(f(std::declval<TravelOptions &>())) {
+      std::lock_guard<std::mutex> g(_write);
+      struct Publish {
+        ConcurrentTravelOptions *c;
+        ~Publish() { c->publish(); }
+      } p = { this };
+      return f(_master);
+    }
+
+   /**
+   * func: insert_sorted / insert_pareto_sorted / prune_sorted / clear
+   * desc: the TravelOptions operations, applied to the master and published as a new version
+   *       (group-committed with any other queued writers, see top of file)
+   * returns: as the TravelOptions operation
+   * RUNTIME:  the operation, plus O(n) per publish (shared by the writers of one batch)
+   * status:  DONE
+   */
+    bool insert_sorted(double price, double time) {
+      return apply([=](TravelOptions &m) { return m.insert_sorted(price, time); });
+    }
+
+    bool insert_pareto_sorted(double price, double time) {
+      return apply([=](TravelOptions &m) { return m.insert_pareto_sorted(price, time); });
+    }
+
+    bool prune_sorted() {
+      return apply([](TravelOptions &m) { return m.prune_sorted(); });
+    }
+
+    void clear() {
+      apply([](TravelOptions &m) { m.clear(); return true; });
+    }
+
+   /**
+   * func: size / version / to_vec / best_time_within_budget / cheapest_within_time
+   * desc: one-shot reads of the current version (each takes its own ReadGuard; use a ReadGuard
+   *       directly to run several queries against the same version)
+   * status:  DONE
+   */
+    int size() const {
+      ReadGuard g(*this);
+      return g.view().size();
+    }
+
+    uint64_t version() const {
+      ReadGuard g(*this);
+      return g.snapshot().version();
+    }
+
+    std::vector<std::pair<double, double>> * to_vec() const {
+      ReadGuard g(*this);
+      return g.view().to_vec();
+    }
+
+    bool best_time_within_budget(double budget, double &price, double &time) const {
+      ReadGuard g(*this);
+      return g.view().best_time_within_budget(budget, price, time);
+    }
+
+    bool cheapest_within_time(double max_time, double &price, double &time) const {
+      ReadGuard g(*this);
+      return g.view().cheapest_within_time(max_time, price, time);
+    }
+};
+
+#endif
@@ -0,0 +1,229 @@
+#ifndef _DOMINANCE_H
+#define _DOMINANCE_H
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DOMINANCE_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * dominance:  vectorized kernels that compare one <price,time> option against a block of
+ *   options stored as two arrays (prices and times).
+ *
+ * Results follow TravelOptions::compare exactly (A is the single option, B[j] the block):
+ *     equal         pa == pb[j] and ta == tb[j]
+ *     better        otherwise, pa <= pb[j] and ta <= tb[j]
+ *     worse         otherwise, pa >= pb[j] and ta >= tb[j]
+ *     incomparable  everything else (including any comparison with a NaN)
+ *
+ * Three implementations:  AVX2 (4 doubles per vector, 8 options per step), SSE2 (2 per
+ *   vector) and portable scalar.  On x86-64 the best one is picked once at run time;
+ *   elsewhere the scalar one is used.  Define DOMINANCE_SCALAR to force the scalar kernels.
+ *   Prices and times of other types (int32_t, float, ...) always take the scalar templates.
+ */
+namespace dominance {
+
+  // same values as TravelOptions::Relationship
+  enum Code { BETTER=0, WORSE=1, EQUAL=2, INCOMPARABLE=3 };
+
+  // lane code from the three lane masks (eq / le / ge)
+  inline unsigned char code(bool eq, bool le, bool ge) {
+    return eq ? EQUAL : le ? BETTER : ge ? WORSE : INCOMPARABLE;
+  }
+
+  namespace scalar {
+
+    template <typename P, typename T>
+    inline void compare_block(P pa, T ta, const P *pb, const T *tb,
+                              size_t n, unsigned char *out) {
+      for(size_t j=0; j<n; j++)
+        out[j] = code(pa == pb[j] && ta == tb[j], pa <= pb[j] && ta <= tb[j],
+                      pa >= pb[j] && ta >= tb[j]);
+    }
+
+    // number of j with pb[j] <= p and tb[j] <= t (B[j] better than or equal to <p,t>);
+    //   stops counting once limit is reached
+    template <typename P, typename T>
+    inline size_t count_covering(P p, T t, const P *pb, const T *tb,
+                                 size_t n, size_t limit) {
+      size_t c = 0;
+      for(size_t j=0; j<n && c<limit; j++)
+        c += (pb[j] <= p && tb[j] <= t);
+      return c;
+    }
+  }
+
+#ifdef DOMINANCE_X86
+  namespace sse2 {
+
+    inline void compare_block(double pa, double ta, const double *pb, const double *tb,
+                              size_t n, unsigned char *out) {
+      __m128d vp = _mm_set1_pd(pa), vt = _mm_set1_pd(ta);
+      size_t j = 0;
+
+      for(; j+2<=n; j+=2) {
+        __m128d bp = _mm_loadu_pd(pb + j), bt = _mm_loadu_pd(tb + j);
+        int eq = _mm_movemask_pd(_mm_and_pd(_mm_cmpeq_pd(vp, bp), _mm_cmpeq_pd(vt, bt)));
+        int le = _mm_movemask_pd(_mm_and_pd(_mm_cmple_pd(vp, bp), _mm_cmple_pd(vt, bt)));
+        int ge = _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(vp, bp), _mm_cmpge_pd(vt, bt)));
+        for(int k=0; k<2; k++)
+          out[j+k] = code(eq >> k & 1, le >> k & 1, ge >> k & 1);
+      }
+      scalar::compare_block(pa, ta, pb + j, tb + j, n - j, out + j);
+    }
+
+    inline size_t count_covering(double p, double t, const double *pb, const double *tb,
+                                 size_t n, size_t limit) {
+      __m128d vp = _mm_set1_pd(p), vt = _mm_set1_pd(t);
+      size_t c = 0, j = 0;
+
+      for(; j+2<=n && c<limit; j+=2) {
+        __m128d m = _mm_and_pd(_mm_cmple_pd(_mm_loadu_pd(pb + j), vp),
+                               _mm_cmple_pd(_mm_loadu_pd(tb + j), vt));
+        c += __builtin_popcount(_mm_movemask_pd(m));
+      }
+      return c < limit ? c + scalar::count_covering(p, t, pb + j, tb + j, n - j, limit - c) : c;
+    }
+  }
+
+  namespace avx2 {
+
+    __attribute__((target("avx2")))
+    inline void compare_block(double pa, double ta, const double *pb, const double *tb,
+                              size_t n, unsigned char *out) {
+      __m256d vp = _mm256_set1_pd(pa), vt = _mm256_set1_pd(ta);
+      size_t j = 0;
+
+      for(; j+4<=n; j+=4) {
+        __m256d bp = _mm256_loadu_pd(pb + j), bt = _mm256_loadu_pd(tb + j);
+        int eq = _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(vp, bp, _CMP_EQ_OQ),
+                                                  _mm256_cmp_pd(vt, bt, _CMP_EQ_OQ)));
+        int le = _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(vp, bp, _CMP_LE_OQ),
+                                                  _mm256_cmp_pd(vt, bt, _CMP_LE_OQ)));
+        int ge = _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(vp, bp, _CMP_GE_OQ),
+                                                  _mm256_cmp_pd(vt, bt, _CMP_GE_OQ)));
+        for(int k=0; k<4; k++)
+          out[j+k] = code(eq >> k & 1, le >> k & 1, ge >> k & 1);
+      }
+      scalar::compare_block(pa, ta, pb + j, tb + j, n - j, out + j);
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    inline size_t count_covering(double p, double t, const double *pb, const double *tb,
+                                 size_t n, size_t limit) {
+      __m256d vp = _mm256_set1_pd(p), vt = _mm256_set1_pd(t);
+      size_t c = 0, j = 0;
+
+      // two vectors (8 options) per step
+      for(; j+8<=n && c<limit; j+=8) {
+        __m256d m0 = _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(pb + j), vp, _CMP_LE_OQ),
+                                   _mm256_cmp_pd(_mm256_loadu_pd(tb + j), vt, _CMP_LE_OQ));
+        __m256d m1 = _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(pb + j + 4), vp, _CMP_LE_OQ),
+                                   _mm256_cmp_pd(_mm256_loadu_pd(tb + j + 4), vt, _CMP_LE_OQ));
+        c += __builtin_popcount(_mm256_movemask_pd(m0) | _mm256_movemask_pd(m1) << 4);
+      }
+      return c < limit ? c + scalar::count_covering(p, t, pb + j, tb + j, n - j, limit - c) : c;
+    }
+  }
+#endif
+
+  typedef void (*compare_fn)(double, double, const double *, const double *, size_t, unsigned char *);
+  typedef size_t (*count_fn)(double, double, const double *, const double *, size_t, size_t);
+
+  inline bool has_avx2() {
+#if defined(DOMINANCE_X86) && !defined(DOMINANCE_SCALAR)
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * func: compare_block
+   * desc: out[j] = compare(pa, ta, pb[j], tb[j]) for j in [0, n), as a Code.
+   */
+  inline void compare_block(double pa, double ta, const double *pb, const double *tb,
+                            size_t n, unsigned char *out) {
+#if defined(DOMINANCE_X86) && !defined(DOMINANCE_SCALAR)
+    static const compare_fn f = has_avx2() ? avx2::compare_block : sse2::compare_block;
+#else
+    static const compare_fn f = scalar::compare_block;
+#endif
+    f(pa, ta, pb, tb, n, out);
+  }
+
+  template <typename P, typename T>
+  inline void compare_block(P pa, T ta, const P *pb, const T *tb, size_t n, unsigned char *out) {
+    scalar::compare_block(pa, ta, pb, tb, n, out);
+  }
+
+  /**
+   * func: count_covering
+   * desc: how many of the n options are better than or equal to <p,t> (i.e., would make
+   *       <p,t> useless), counting up to limit:  min(count, limit), as the scalar loop returns.
+   *       The vector kernels stop a whole step past the limit, so their count is clamped.
+   */
+  inline size_t count_covering(double p, double t, const double *pb, const double *tb,
+                               size_t n, size_t limit) {
+#if defined(DOMINANCE_X86) && !defined(DOMINANCE_SCALAR)
+    static const count_fn f = has_avx2() ? avx2::count_covering : sse2::count_covering;
+#else
+    static const count_fn f = scalar::count_covering;
+#endif
+    return std::min(f(p, t, pb, tb, n, limit), limit);
+  }
+
+  template <typename P, typename T>
+  inline size_t count_covering(P p, T t, const P *pb, const T *tb, size_t n, size_t limit) {
+    return scalar::count_covering(p, t, pb, tb, n, limit);
+  }
+
+  /**
+   * func: is_pareto
+   * desc: true iff the n options are all distinct and none dominates another (same answer
+   *       as the pairwise TravelOptions::is_pareto).
+   *
+   *       Each option is covered by itself, so the set is pareto iff every option is covered
+   *       exactly once.  Small sets run that all-pairs test with the vector kernel (no
+   *       allocation).  Larger sets are sorted by price instead:  a sorted set is pareto iff
+   *       it is strictly increasing in price and strictly decreasing in time, which makes
+   *       100k-option checks take milliseconds instead of seconds.  Sets containing a NaN
+   *       (which cannot be sorted) always take the all-pairs path.
+   *
+   * RUNTIME: O(n^2 / width) for n <= small; O(n log n) otherwise
+   */
+  template <typename P, typename T>
+  inline bool is_pareto(const P *price, const T *time, size_t n, size_t small=256) {
+    bool has_nan = false;
+
+    for(size_t i=0; i<n; i++)
+      has_nan |= (price[i] != price[i]) || (time[i] != time[i]);
+
+    if(n <= small || has_nan) {
+      for(size_t i=0; i<n; i++) {
+        // a NaN option is covered by nothing (not even itself); it is incomparable to all
+        size_t self = (price[i] == price[i] && time[i] == time[i]) ? 1 : 0;
+        if(count_covering(price[i], time[i], price, time, n, self + 1) > self)
+          return false;
+      }
+      return true;
+    }
+
+    std::vector<std::pair<P, T>> buf(n);
+    for(size_t i=0; i<n; i++)
+      buf[i] = std::pair<P, T>(price[i], time[i]);
+    std::sort(buf.begin(), buf.end());
+    for(size_t i=1; i<n; i++) {
+      if(buf[i-1].first >= buf[i].first || buf[i-1].second <= buf[i].second)
+        return false;
+    }
+    return true;
+  }
+}
+
+#endif
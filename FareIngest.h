@@ -0,0 +1,333 @@
+#ifndef _FARE_INGEST_H
+#define _FARE_INGEST_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <type_traits>
+
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
+
+#include "TravelOptions.h"
+
+/**
+ * FareIngest:  streams fare feeds (lines of origin,dest,price,time) into one pareto-sorted
+ *   TravelOptions per route, without materializing the input.
+ *
+ * The feed is read in chunks of a fixed size; each complete line in the chunk is parsed in place
+ *   and its option is queued on its route.  A route's queue is merged into its frontier with
+ *   insert_pareto_sorted_batch once it holds as many options as the frontier (at least BATCH), so
+ *   each merge walks the frontier once for many options instead of once per option; every ingest
+ *   call ends by merging all queues, so between calls each frontier is exact.  Memory is the
+ *   frontiers, a queue of at most max(BATCH, frontier size) options per route and one chunk (a
+ *   line longer than a chunk grows the buffer to fit it), whatever the size of the feed.
+ *
+ * The route key is the text origin,dest as it appears in the line (e.g. "JFK,LAX").  Blank lines
+ *   are skipped; a line that does not have four fields with numeric (non-NaN) price and time, e.g.
+ *   a header, is counted as rejected.  A trailing '\r' (CRLF files) is ignored.
+ *
+ * Numbers are parsed with std::from_chars when the library has it for floating point (C++17);
+ *   older compilers fall back to strtod / strtoll on a copy of the field.
+ *
+ * stats() counts records, rejected lines, bytes and the wall time spent inside the ingest calls,
+ *   for records/sec.
+ */
+template <typename Price = double, typename Time = double>
+class BasicFareIngest{
+
+  public:
+    typedef BasicTravelOptions<Price, Time> Options;
+
+    struct Stats {
+      uint64_t records;    // lines that went into a frontier
+      uint64_t rejected;   // non-blank lines that did not parse
+      uint64_t bytes;
+      double seconds;      // wall time spent in ingest_file / ingest / ingest_text
+
+      double records_per_sec() const {
+        return seconds > 0 ? records / seconds : 0;
+      }
+    };
+
+    enum { BATCH = 64 };   // smallest queue that is merged
+
+  private:
+    struct Route {
+      Options options;
+      std::vector<std::pair<Price, Time>> pending;   // read, not yet merged into options
+    };
+
+    std::unordered_map<std::string, Route> _routes;
+    std::string _key;          // key of the last record, reused for lookups
+    Route *_last;              // route of the last record (feeds are often grouped by route)
+    std::vector<char> _buf;
+    size_t _chunk;
+    Stats _stats;
+
+    BasicFareIngest(const BasicFareIngest &) = delete;
+    BasicFareIngest & operator=(const BasicFareIngest &) = delete;
+
+    /**
+     * func: parse
+     * desc: private utility; parses the whole field [b, e) as a number of type T.
+     * returns: false if the field is empty, has anything after the number or is NaN.
+     */
+    template <typename T>
+    static bool parse(const char *b, const char *e, T &v) {
+      while(b < e && (*b == ' ' || *b == '\t'))
+        b++;
+      while(e > b && (e[-1] == ' ' || e[-1] == '\t'))
+        e--;
+      if(b == e)
+        return false;
+#if defined(__cpp_lib_to_chars)
+      // from_chars takes no '+'; skip one only in front of a digit or '.' (so "+-5" stays invalid)
+      if(*b == '+' && e - b > 1 && ((b[1] >= '0' && b[1] <= '9') || b[1] == '.'))
+        b++;
+      std::from_chars_result r = std::from_chars(b, e, v);
+      return r.ec == std::errc() && r.ptr == e && v == v;
+#else
+      char tmp[64];
+      char *end;
+      size_t len = e - b;
+      if(len >= sizeof(tmp))
+        return false;
+      memcpy(tmp, b, len);
+      tmp[len] = '\0';
+      errno = 0;
+      if(std::is_integral<T>::value) {
+        long long x = strtoll(tmp, &end, 10);
+        v = (T)x;
+        if(errno != 0 || (long long)v != x)
+          return false;
+      }
+      else {
+        v = (T)strtod(tmp, &end);
+      }
+      return end == tmp + len && v == v;
+#endif
+    }
+
+    /**
+     * func: record
+     * desc: private utility; parses one line (without its '\n') and inserts the option into its
+     *       route's frontier.
+     */
+    void record(const char *b, const char *e) {
+      if(e > b && e[-1] == '\r')
+        e--;
+      if(b == e)
+        return;
+
+      const char *c1 = (const char *)memchr(b, ',', e - b);
+      const char *c2 = c1 ? (const char *)memchr(c1 + 1, ',', e - c1 - 1) : nullptr;
+      const char *c3 = c2 ? (const char *)memchr(c2 + 1, ',', e - c2 - 1) : nullptr;
+      Price price;
+      Time time;
+
+      if(c3 == nullptr || memchr(c3 + 1, ',', e - c3 - 1) != nullptr ||
+         !parse(c2 + 1, c3, price) || !parse(c3 + 1, e, time)) {
+        _stats.rejected++;
+        return;
+      }
+
+      size_t klen = c2 - b;
+      if(_last == nullptr || _key.size() != klen || memcmp(_key.data(), b, klen) != 0) {
+        _key.assign(b, klen);
+        _last = &_routes[_key];
+      }
+      _last->pending.push_back(std::make_pair(price, time));
+      if(_last->pending.size() >= std::max((size_t)BATCH, (size_t)_last->options.size()))
+        merge(*_last);
+      _stats.records++;
+    }
+
+    // merges a route's queue into its frontier
+    static void merge(Route &r) {
+      r.options.insert_pareto_sorted_batch(r.pending);
+      r.pending.clear();
+    }
+
+    // merges every queue; ends each ingest call
+    void merge_all() {
+      for(typename std::unordered_map<std::string, Route>::iterator it = _routes.begin();
+          it != _routes.end(); ++it)
+        merge(it->second);
+    }
+
+    /**
+     * func: lines
+     * desc: private utility; records every complete line of [b, e).
+     * returns: pointer to the first byte after the last '\n' (the start of a partial line)
+     */
+    const char * lines(const char *b, const char *e) {
+      const char *nl;
+
+      while(b < e && (nl = (const char *)memchr(b, '\n', e - b)) != nullptr) {
+        record(b, nl);
+        b = nl + 1;
+      }
+      return b;
+    }
+
+    void add_time(std::chrono::steady_clock::time_point t0) {
+      _stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+  public:
+    explicit BasicFareIngest(size_t chunk = 1 << 20) : _last(nullptr), _chunk(std::max<size_t>(chunk, 64)) {
+      _stats.records = 0;
+      _stats.rejected = 0;
+      _stats.bytes = 0;
+      _stats.seconds = 0;
+    }
+
+   /**
+   * func: ingest_file
+   * desc: streams the feed at path into the frontiers (see ingest)
+   * returns: false if the file cannot be opened or read
+   * status:  DONE
+   */
+    bool ingest_file(const char *path) {
+      FILE *in = fopen(path, "rb");
+      if(in == nullptr)
+        return false;
+      bool ok = ingest(in);
+      fclose(in);
+      return ok;
+    }
+
+   /**
+   * func: ingest
+   * desc: reads the stream to EOF one chunk at a time; the partial line at the end of a chunk is
+   *       carried over to the next one.  A last line without '\n' is still a record.
+   * returns: false on a read error (records read before it are kept)
+   * RUNTIME:  O(bytes) parsing; about O(log b) per record for merging, for queues of b options
+   * status:  DONE
+   */
+    bool ingest(FILE *in) {
+      std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+      size_t carry = 0;
+
+      if(_buf.size() < _chunk)
+        _buf.resize(_chunk);
+      for(;;) {
+        if(carry == _buf.size())
+          _buf.resize(2 * _buf.size());   // one line longer than the buffer
+        size_t got = fread(_buf.data() + carry, 1, _buf.size() - carry, in);
+        _stats.bytes += got;
+        if(got == 0)
+          break;
+        const char *end = _buf.data() + carry + got;
+        const char *rest = lines(_buf.data(), end);
+        carry = end - rest;
+        memmove(_buf.data(), rest, carry);
+      }
+      record(_buf.data(), _buf.data() + carry);
+      merge_all();
+      add_time(t0);
+      return !ferror(in);
+    }
+
+   /**
+   * func: ingest_text
+   * desc: same as ingest, for a feed (or a piece of one made of whole lines) already in memory
+   * status:  DONE
+   */
+    void ingest_text(const char *data, size_t len) {
+      std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+      const char *rest = lines(data, data + len);
+
+      record(rest, data + len);
+      merge_all();
+      _stats.bytes += len;
+      add_time(t0);
+    }
+
+   /**
+   * func: routes / keys
+   * desc: the number of routes seen so far / their keys, sorted
+   * status:  DONE
+   */
+    int routes() const {
+      return (int)_routes.size();
+    }
+
+    std::vector<std::string> keys() const {
+      std::vector<std::string> k;
+
+      k.reserve(_routes.size());
+      for(typename std::unordered_map<std::string, Route>::const_iterator it = _routes.begin();
+          it != _routes.end(); ++it)
+        k.push_back(it->first);
+      std::sort(k.begin(), k.end());
+      return k;
+    }
+
+   /**
+   * func: find
+   * desc: the frontier of a route, by key ("origin,dest") or by its two parts
+   * returns: pointer to the frontier (owned by this object); nullptr if the route was never seen
+   * status:  DONE
+   */
+    const Options * find(const std::string &key) const {
+      typename std::unordered_map<std::string, Route>::const_iterator it = _routes.find(key);
+      return it == _routes.end() ? nullptr : &it->second.options;
+    }
+
+    const Options * find(const std::string &origin, const std::string &dest) const {
+      return find(origin + "," + dest);
+    }
+
+   /**
+   * func: save_binary
+   * desc: writes every route's frontier to one FrontierFile, under its route key
+   * returns: as Options::save_binary
+   * status:  DONE
+   */
+    bool save_binary(const char *path) const {
+      std::vector<std::string> k = keys();
+      std::vector<std::pair<std::string, const Options *>> all(k.size());
+
+      for(size_t i=0; i<k.size(); i++)
+        all[i] = std::make_pair(k[i], find(k[i]));
+      return Options::save_binary(path, all);
+    }
+
+   /**
+   * func: stats
+   * desc: counters since construction (or the last clear)
+   * status:  DONE
+   */
+    const Stats & stats() const {
+      return _stats;
+    }
+
+   /**
+   * func: clear
+   * desc: drops every frontier and resets the counters
+   * status:  DONE
+   */
+    void clear() {
+      _routes.clear();
+      _last = nullptr;
+      _stats.records = 0;
+      _stats.rejected = 0;
+      _stats.bytes = 0;
+      _stats.seconds = 0;
+    }
+};
+
+typedef BasicFareIngest<> FareIngest;
+
+#endif
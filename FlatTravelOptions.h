@@ -0,0 +1,471 @@
+#ifndef _FLAT_TRVL_OPTNS_H
+#define _FLAT_TRVL_OPTNS_H
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdio>
+
+#include "TravelOptions.h"
+
+/**
+ * FlatTravelOptions: contiguous (structure-of-arrays) storage for <price,time> options.
+ *
+ * Same public API as TravelOptions, but prices and times live in two parallel arrays
+ *   instead of one heap Node per option.  Scans (is_sorted, is_pareto, prune_sorted,
+ *   join_plus_plus, ...) walk memory linearly instead of chasing next pointers.
+ *
+ * Options occupy positions [_first, _price.size()) of the arrays.  The slots before
+ *   _first are slack so that push_front is amortized O(1) like the linked version.
+ */
+class FlatTravelOptions{
+
+  public:
+    typedef TravelOptions::Relationship Relationship;
+
+  private:
+    std::vector<double> _price;
+    std::vector<double> _time;
+    size_t _first;
+
+  public:
+    // constructors
+    FlatTravelOptions() {
+      _first = 0;
+    }
+
+   /**
+   * func: clear
+   * desc: Removes all options (keeps the array capacity for reuse)
+   * status:  DONE
+   */
+    void clear(){
+      _price.clear();
+      _time.clear();
+      _first = 0;
+    }
+
+   /**
+   * func: size
+   * desc: returns the number of elements in the list
+   * status:  DONE
+   */
+    int size( ) const {
+      return (int)(_price.size() - _first);
+    }
+
+   /**
+   * func: compare
+   * desc: same as TravelOptions::compare
+   * status:  DONE
+   */
+    static Relationship compare(double priceA, double timeA,
+                                double priceB, double timeB) {
+      return TravelOptions::compare(priceA, timeA, priceB, timeB);
+    }
+
+   /**
+   * func: price / time
+   * desc: read access to the i-th option (0 is the front of the list)
+   * status:  DONE
+   */
+    double price(int i) const { return _price[_first + i]; }
+    double time(int i) const { return _time[_first + i]; }
+
+   /**
+   * func: push_front
+   * desc: Adds a <price,time> option to the front of the list.
+   * RUNTIME: amortized O(1); when the front slack runs out the arrays are regrown
+   *          with as much slack as there are options.
+   * status:  DONE
+   */
+    void push_front(double price, double time) {
+      if(_first == 0) {
+        size_t n = _price.size();
+        size_t slack = n < 8 ? 8 : n;
+
+        _price.insert(_price.begin(), slack, 0.0);
+        _time.insert(_time.begin(), slack, 0.0);
+        _first = slack;
+      }
+      _first--;
+      _price[_first] = price;
+      _time[_first] = time;
+    }
+
+   /**
+   * func: from_vec
+   * desc: builds a FlatTravelOptions object with exactly the options in vec (same order).
+   *       The arrays are sized once and filled directly (no per-option allocation).
+   * returns: a pointer to the resulting object
+   * status:  DONE
+   */
+    static FlatTravelOptions * from_vec(std::vector<std::pair<double, double> > &vec) {
+      FlatTravelOptions *options = new FlatTravelOptions();
+
+      options->_price.resize(vec.size());
+      options->_time.resize(vec.size());
+      for(size_t i=0; i<vec.size(); i++) {
+        options->_price[i] = vec[i].first;
+        options->_time[i] = vec[i].second;
+      }
+      return options;
+    }
+
+   /**
+   * func: from_options
+   * desc: bulk-loads the options of a (linked) TravelOptions object, same order.
+   * status:  DONE
+   */
+    static FlatTravelOptions * from_options(const TravelOptions &list) {
+      std::vector<std::pair<double, double>> *vec = list.to_vec();
+      FlatTravelOptions *options = from_vec(*vec);
+
+      delete vec;
+      return options;
+    }
+
+   /**
+   * func: to_vec
+   * desc: creates a vector of <price,time> pairs with the options in the calling object
+   *       (in the same order).
+   * returns: a pointer to the resulting vector
+   * status:  DONE
+   */
+    std::vector<std::pair<double, double>> * to_vec() const {
+      std::vector<std::pair<double, double>> *vec = new std::vector<std::pair<double, double>>();
+
+      vec->reserve(size());
+      for(size_t i=_first; i<_price.size(); i++)
+        vec->push_back(std::pair<double,double>(_price[i], _time[i]));
+      return vec;
+    }
+
+   /**
+   * func: to_options
+   * desc: creates a (linked) TravelOptions object with the same options, same order.
+   * status:  DONE
+   */
+    TravelOptions * to_options() const {
+      TravelOptions *options = new TravelOptions();
+
+      for(size_t i=_price.size(); i>_first; i--)
+        options->push_front(_price[i-1], _time[i-1]);
+      return options;
+    }
+
+   /**
+   * func: is_sorted
+   * desc: non-decreasing price; time breaks ties (see TravelOptions::is_sorted)
+   * RUNTIME: O(n)
+   * status:  DONE
+   */
+    bool is_sorted() const {
+      for(size_t i=_first+1; i<_price.size(); i++) {
+        if(_price[i-1] > _price[i])
+          return false;
+        if(_price[i-1] == _price[i] && _time[i-1] > _time[i])
+          return false;
+      }
+      return true;
+    }
+
+   /**
+   * func: is_pareto
+   * desc: true iff all options are distinct and none is dominated by another
+   * RUNTIME: vectorized all-pairs for small lists, O(n log n) otherwise
+   *          (see dominance::is_pareto)
+   * status:  DONE
+   */
+    bool is_pareto() const {
+      return dominance::is_pareto(_price.data() + _first, _time.data() + _first, size());
+    }
+
+   /**
+   * func: is_pareto_sorted
+   * desc: strictly increasing in price and strictly decreasing in time
+   * RUNTIME: O(n)
+   * status:  DONE
+   */
+    bool is_pareto_sorted() const {
+      for(size_t i=_first+1; i<_price.size(); i++) {
+        if(_price[i-1] >= _price[i] || _time[i-1] <= _time[i])
+          return false;
+      }
+      return true;
+    }
+
+   /**
+   * func: insert_sorted
+   * preconditions: calling object must be sorted (false is returned otherwise).
+   * desc: inserts <price,time> keeping the list sorted; the position is found by
+   *       binary search.
+   * RUNTIME: O(n) (O(log n) search plus shifting the tail)
+   * status:  DONE
+   */
+    bool insert_sorted(double price, double time) {
+      if(!is_sorted()) return false;
+
+      size_t lo = _first, hi = _price.size();
+      //first option that belongs after <price,time>
+      while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(_price[mid] < price || (_price[mid] == price && _time[mid] <= time))
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      _price.insert(_price.begin() + lo, price);
+      _time.insert(_time.begin() + lo, time);
+      return true;
+    }
+
+   /**
+   * func: insert_pareto_sorted
+   * preconditions: calling object must be sorted and pareto (false is returned otherwise).
+   * desc: inserts <price,time> unless it is dominated; options it dominates are removed.
+   * RUNTIME: O(n)
+   * status:  DONE
+   */
+    bool insert_pareto_sorted(double price, double time) {
+      if(!is_pareto_sorted()) return false;
+
+      size_t n = _price.size();
+      size_t pos = std::lower_bound(_price.begin() + _first, _price.end(), price) - _price.begin();
+
+      if(pos > _first && _time[pos-1] <= time)
+        return true;
+      if(pos < n && _price[pos] == price && _time[pos] <= time)
+        return true;
+
+      //[pos, end) is at least as expensive; the slower ones form a prefix
+      size_t end = pos;
+      while(end < n && _time[end] >= time)
+        end++;
+      if(end > pos) {
+        _price[pos] = price;
+        _time[pos] = time;
+        _price.erase(_price.begin() + pos + 1, _price.begin() + end);
+        _time.erase(_time.begin() + pos + 1, _time.begin() + end);
+      }
+      else {
+        _price.insert(_price.begin() + pos, price);
+        _time.insert(_time.begin() + pos, time);
+      }
+      return true;
+    }
+
+   /**
+   * func: union_pareto_sorted
+   * precondition: both collections must be sorted and pareto (nullptr returned otherwise).
+   * desc: sorted, pareto union of the two collections as a new object
+   * RUNTIME: O(n+m)
+   * status:  DONE
+   */
+    FlatTravelOptions * union_pareto_sorted(const FlatTravelOptions &other) const {
+      if(!is_pareto_sorted() || !other.is_pareto_sorted())
+        return nullptr;
+
+      FlatTravelOptions *result = new FlatTravelOptions();
+      size_t i = _first, n = _price.size();
+      size_t j = other._first, m = other._price.size();
+
+      result->_price.reserve((n - i) + (m - j));
+      result->_time.reserve((n - i) + (m - j));
+      while(i < n || j < m) {
+        double p, t;
+        if(j == m || (i < n && (_price[i] < other._price[j] ||
+                      (_price[i] == other._price[j] && _time[i] <= other._time[j])))) {
+          p = _price[i]; t = _time[i]; i++;
+        }
+        else {
+          p = other._price[j]; t = other._time[j]; j++;
+        }
+        if(result->_time.empty() || t < result->_time.back()) {
+          result->_price.push_back(p);
+          result->_time.push_back(t);
+        }
+      }
+      return result;
+    }
+
+   /**
+   * func: prune_sorted
+   * precondition: collection must be sorted (false is returned otherwise).
+   * desc: removes dominated options and duplicates by compacting the arrays in place
+   * RUNTIME: O(n)
+   * status:  DONE
+   */
+    bool prune_sorted() {
+      if(!is_sorted()) return false;
+
+      size_t n = _price.size();
+      size_t out = _first;
+      for(size_t i=_first; i<n; i++) {
+        if(out == _first || _time[i] < _time[out-1]) {
+          _price[out] = _price[i];
+          _time[out] = _time[i];
+          out++;
+        }
+      }
+      _price.resize(out);
+      _time.resize(out);
+      return true;
+    }
+
+   /**
+   * func: join_plus_plus
+   * desc: sorted-pareto list of all <p1+p2, t1+t2> combinations (see TravelOptions).  Both inputs
+   *       are reduced to their frontiers, then merged by the same engine as the linked version
+   *       (PlusPlusMerge), which reads the price and time arrays in place.  The n x m product is
+   *       never materialized.
+   * returns: pointer to a new object (empty if either list is empty)
+   * RUNTIME: O(n log n + m log m) for the frontiers, then see PlusPlusMerge; the number of heap
+   *          steps tracks the output frontier, not n x m.
+   * status:  DONE
+   */
+    FlatTravelOptions * join_plus_plus(const FlatTravelOptions &other) const {
+      FlatTravelOptions *tr = new FlatTravelOptions();
+      FlatTravelOptions a, b;
+      double p, t;
+
+      frontier(a);
+      other.frontier(b);
+
+      PlusPlusMerge<double, double> merge(a._price.data() + a._first, a._time.data() + a._first, a.size(),
+                                          b._price.data() + b._first, b._time.data() + b._first, b.size());
+      while(merge.next(p, t)) {
+        tr->_price.push_back(p);
+        tr->_time.push_back(t);
+      }
+      return tr;
+    }
+
+   /**
+   * func: join_plus_max
+   * preconditions: both lists must be sorted and pareto (nullptr returned otherwise).
+   * desc: sorted-pareto list of all <p1+p2, MAX(t1,t2)> combinations; two-pointer merge
+   *       that advances the slower side (see TravelOptions::join_plus_max)
+   * RUNTIME: O(n+m)
+   * status:  DONE
+   */
+    FlatTravelOptions * join_plus_max(const FlatTravelOptions &other) const {
+      if(!is_pareto_sorted() || !other.is_pareto_sorted())
+        return nullptr;
+
+      FlatTravelOptions *tr = new FlatTravelOptions();
+      size_t i = _first, n = _price.size();
+      size_t j = other._first, m = other._price.size();
+
+      while(i < n && j < m) {
+        double t = std::max(_time[i], other._time[j]);
+
+        if(tr->_time.empty() || t < tr->_time.back()) {
+          tr->_price.push_back(_price[i] + other._price[j]);
+          tr->_time.push_back(t);
+        }
+        bool adv_a = _time[i] >= other._time[j];
+        bool adv_b = other._time[j] >= _time[i];
+        if(adv_a) i++;
+        if(adv_b) j++;
+      }
+      return tr;
+    }
+
+   /**
+   * func: sorted_clone
+   * desc: returns a sorted object which contains the same elements as the current object
+   * RUNTIME: O(n log n)
+   * status:  DONE
+   */
+    FlatTravelOptions * sorted_clone() const {
+      FlatTravelOptions *sorted = new FlatTravelOptions();
+
+      sorted->_price.assign(_price.begin() + _first, _price.end());
+      sorted->_time.assign(_time.begin() + _first, _time.end());
+      sorted->sort();
+      return sorted;
+    }
+
+   /**
+   * func: split_sorted_pareto
+   * precondition: list must be sorted and pareto (nullptr returned otherwise).
+   * desc: options with price <= max_price stay in the calling object; the more expensive
+   *       ones are moved into a new object which is returned.
+   * RUNTIME: O(log n) to find the cut plus O(k) to move the k expensive options
+   * status:  DONE
+   */
+    FlatTravelOptions * split_sorted_pareto(double max_price) {
+      if(!is_pareto_sorted())
+        return nullptr;
+
+      FlatTravelOptions *tr = new FlatTravelOptions();
+      size_t cut = std::upper_bound(_price.begin() + _first, _price.end(), max_price) - _price.begin();
+
+      tr->_price.assign(_price.begin() + cut, _price.end());
+      tr->_time.assign(_time.begin() + cut, _time.end());
+      _price.resize(cut);
+      _time.resize(cut);
+      return tr;
+    }
+
+   /**
+   * func: display
+   * desc: prints a string representation of the current object
+   * status:  DONE
+   */
+    void display() const {
+      printf("   PRICE      TIME\n");
+      printf("---------------------\n");
+      for(size_t i=_first; i<_price.size(); i++)
+        printf("   %5.2f      %5.2f\n", _price[i], _time[i]);
+    }
+
+  private:
+
+   /**
+   * func: frontier
+   * desc: out is overwritten with the sorted-pareto frontier of the calling object's options
+   *       (a plain copy if they already are sorted-pareto; sort and prune otherwise).
+   * RUNTIME: O(n) or O(n log n)
+   */
+    void frontier(FlatTravelOptions &out) const {
+      out._price.assign(_price.begin() + _first, _price.end());
+      out._time.assign(_time.begin() + _first, _time.end());
+      out._first = 0;
+      if(!is_pareto_sorted()) {
+        out.sort();
+        out.prune_sorted();
+      }
+    }
+
+   /**
+   * func: sort
+   * desc: sorts the options by price (time breaks ties) with an index permutation,
+   *       then gathers both arrays through it.
+   * RUNTIME: O(n log n)
+   */
+    void sort() {
+      size_t n = _price.size() - _first;
+      std::vector<size_t> idx(n);
+
+      for(size_t i=0; i<n; i++)
+        idx[i] = _first + i;
+      std::sort(idx.begin(), idx.end(), [this](size_t a, size_t b) {
+        return _price[a] < _price[b] || (_price[a] == _price[b] && _time[a] < _time[b]);
+      });
+
+      std::vector<double> price(n), time(n);
+      for(size_t i=0; i<n; i++) {
+        price[i] = _price[idx[i]];
+        time[i] = _time[idx[i]];
+      }
+      _price.swap(price);
+      _time.swap(time);
+      _first = 0;
+    }
+
+};
+
+#endif
@@ -0,0 +1,428 @@
+#ifndef _FRONTIER_FILE_H
+#define _FRONTIER_FILE_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * FrontierFile:  binary file of many <price,time> frontiers, each stored under a route key,
+ *   that is memory-mapped and queried in place (no parsing, no Node per option).
+ *
+ * Layout (version 1, host byte order; a file written on a machine of the other
+ *   endianness fails the version check).  Every section starts on an 8-byte boundary.
+ *
+ *     header      64 bytes:  magic "TRVLOPT", version, count, directory offset, keys offset,
+ *                 file size, checksum
+ *     records     per frontier, count contiguous records of two doubles (price, time)
+ *     directory   count entries (records offset, length, key offset, key length, flags),
+ *                 sorted by key
+ *     keys        the key bytes, back to back (padded to a multiple of 8)
+ *
+ *   flags records what held for the options when they were saved (same bits as
+ *   TravelOptions:  1 sorted, 2 pareto, 4 pareto-sorted).  The checksum is a 64-bit FNV-1a
+ *   over the 8-byte words after the header.
+ *
+ * Written by TravelOptions::save_binary (or FrontierFile::write); opened by
+ *   TravelOptions::load_mapped (or FrontierFile::open).  POSIX only (mmap).
+ */
+
+/**
+ * MappedOptions:  read-only view of one frontier inside a FrontierFile (valid as long as the
+ *   file is open).  Copying a view copies a pointer and a length, never the options.
+ */
+class MappedOptions{
+
+  public:
+    enum { SORTED=1, PARETO=2, PARETO_SORTED=4 };
+
+  private:
+    const double *_rec;   // price of option i is _rec[2*i], time is _rec[2*i+1]
+    size_t _n;
+    unsigned _flags;
+
+    // first option with price > p (binary search; requires sorted)
+    size_t upper_price(double p) const {
+      size_t lo = 0, hi = _n;
+      while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(_rec[2*mid] <= p) lo = mid + 1;
+        else hi = mid;
+      }
+      return lo;
+    }
+
+    // first option with price >= p
+    size_t lower_price(double p) const {
+      size_t lo = 0, hi = _n;
+      while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(_rec[2*mid] < p) lo = mid + 1;
+        else hi = mid;
+      }
+      return lo;
+    }
+
+  public:
+    MappedOptions() : _rec(nullptr), _n(0), _flags(SORTED | PARETO | PARETO_SORTED) {}
+    MappedOptions(const double *rec, size_t n, unsigned flags) : _rec(rec), _n(n), _flags(flags) {}
+
+   /**
+   * func: size / price / time
+   * desc: number of options; read access to the i-th option (0 is the front of the list)
+   * status:  DONE
+   */
+    int size() const { return (int)_n; }
+    double price(int i) const { return _rec[2*i]; }
+    double time(int i) const { return _rec[2*i+1]; }
+
+   /**
+   * func: is_sorted / is_pareto / is_pareto_sorted
+   * desc: answered from the flags saved with the frontier
+   * RUNTIME:  O(1)
+   * status:  DONE
+   */
+    bool is_sorted() const { return (_flags & SORTED) != 0; }
+    bool is_pareto() const { return (_flags & PARETO) != 0; }
+    bool is_pareto_sorted() const { return (_flags & PARETO_SORTED) != 0; }
+
+   /**
+   * func: to_vec
+   * desc: copies the options into a new vector (as TravelOptions::to_vec)
+   * status:  DONE
+   */
+    std::vector<std::pair<double, double>> * to_vec() const {
+      std::vector<std::pair<double, double>> *vec = new std::vector<std::pair<double, double>>();
+      vec->reserve(_n);
+      for(size_t i=0; i<_n; i++)
+        vec->push_back(std::pair<double,double>(_rec[2*i], _rec[2*i+1]));
+      return vec;
+    }
+
+   /**
+   * func: split_sorted_pareto
+   * precondition:  the frontier is sorted-pareto (if not, false is returned).
+   * desc: the mapped counterpart of TravelOptions::split_sorted_pareto:  cheap is set to the
+   *       options with price <= max_price and expensive to the others.  Both are views into the
+   *       same records (nothing is copied or changed).
+   * RUNTIME:  O(log n)
+   * status:  DONE
+   */
+    bool split_sorted_pareto(double max_price, MappedOptions &cheap, MappedOptions &expensive) const {
+      if(!is_pareto_sorted())
+        return false;
+      size_t k = upper_price(max_price);
+      cheap = MappedOptions(_rec, k, _flags);
+      expensive = MappedOptions(_rec + 2*k, _n - k, _flags);
+      return true;
+    }
+
+   /**
+   * func: best_time_within_budget
+   * precondition:  the frontier is sorted-pareto (if not, false is returned).
+   * desc: as TravelOptions::best_time_within_budget
+   * RUNTIME:  O(log n)
+   * status:  DONE
+   */
+    bool best_time_within_budget(double budget, double &price, double &time) const {
+      if(!is_pareto_sorted())
+        return false;
+      size_t k = upper_price(budget);
+      if(k == 0)
+        return false;
+      price = _rec[2*(k-1)];
+      time = _rec[2*(k-1)+1];
+      return true;
+    }
+
+   /**
+   * func: cheapest_within_time
+   * precondition:  the frontier is sorted-pareto (if not, false is returned).
+   * desc: as TravelOptions::cheapest_within_time
+   * RUNTIME:  O(log n)
+   * status:  DONE
+   */
+    bool cheapest_within_time(double max_time, double &price, double &time) const {
+      if(!is_pareto_sorted())
+        return false;
+      size_t lo = 0, hi = _n;   // times are decreasing:  first option with time <= max_time
+      while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(_rec[2*mid+1] > max_time) lo = mid + 1;
+        else hi = mid;
+      }
+      if(lo == _n)
+        return false;
+      price = _rec[2*lo];
+      time = _rec[2*lo+1];
+      return true;
+    }
+
+   /**
+   * func: range
+   * precondition:  the frontier is sorted-pareto (if not, false is returned).
+   * desc: out is set to a view of the options with price_lo <= price <= price_hi
+   * RUNTIME:  O(log n)
+   * status:  DONE
+   */
+    bool range(double price_lo, double price_hi, MappedOptions &out) const {
+      if(!is_pareto_sorted())
+        return false;
+      size_t lo = lower_price(price_lo), hi = std::max(lo, upper_price(price_hi));
+      out = MappedOptions(_rec + 2*lo, hi - lo, _flags);
+      return true;
+    }
+};
+
+
+class FrontierFile{
+
+  public:
+    /* one frontier to write:  its route key, its options (in list order) and its flags */
+    struct Entry {
+      std::string key;
+      std::vector<std::pair<double, double>> options;
+      unsigned flags;
+    };
+
+    static const uint32_t VERSION = 1;
+
+  private:
+    struct Header {
+      char magic[8];
+      uint32_t version;
+      uint32_t count;
+      uint64_t dir_offset;
+      uint64_t keys_offset;
+      uint64_t file_size;
+      uint64_t checksum;
+      uint64_t reserved[2];
+    };
+
+    struct DirEntry {
+      uint64_t rec_offset;
+      uint64_t count;
+      uint64_t key_offset;
+      uint32_t key_len;
+      uint32_t flags;
+    };
+
+    const char *_base;   // the mapping (read-only)
+    size_t _len;
+    const DirEntry *_dir;
+    uint32_t _count;
+
+    FrontierFile() : _base(nullptr), _len(0), _dir(nullptr), _count(0) {}
+    FrontierFile(const FrontierFile &) = delete;
+    FrontierFile & operator=(const FrontierFile &) = delete;
+
+    static const char * magic() { return "TRVLOPT"; }
+
+    static uint64_t pad8(uint64_t n) { return (n + 7) & ~(uint64_t)7; }
+
+    // FNV-1a, one 8-byte word at a time; n is a multiple of 8
+    static uint64_t checksum(const char *p, size_t n) {
+      uint64_t h = 14695981039346656037ULL;
+      for(size_t i=0; i<n; i+=8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 1099511628211ULL;
+      }
+      return h;
+    }
+
+    bool key_less(const DirEntry &e, const std::string &key) const {
+      return std::string(_base + e.key_offset, e.key_len) < key;
+    }
+
+    // every offset in range, records aligned, keys strictly increasing
+    bool valid() const {
+      const Header *h = (const Header *)_base;
+      uint64_t rec_end = h->dir_offset;
+
+      if(h->dir_offset < sizeof(Header) || h->dir_offset % 8 != 0 ||
+         h->keys_offset < h->dir_offset ||
+         (h->keys_offset - h->dir_offset) / sizeof(DirEntry) < h->count ||
+         h->keys_offset > _len)
+        return false;
+      for(uint32_t i=0; i<h->count; i++) {
+        const DirEntry &e = _dir[i];
+        if(e.rec_offset < sizeof(Header) || e.rec_offset % 8 != 0 || e.rec_offset > rec_end ||
+           e.count > (rec_end - e.rec_offset) / 16)
+          return false;
+        if(e.key_offset < h->keys_offset || e.key_offset > _len || e.key_len > _len - e.key_offset)
+          return false;
+        if(i > 0 && !key_less(_dir[i-1], key(i)))
+          return false;
+      }
+      return true;
+    }
+
+  public:
+    ~FrontierFile() {
+      if(_base != nullptr)
+        munmap((void *)_base, _len);
+    }
+
+   /**
+   * func: write
+   * desc: writes the given frontiers to path (replacing it).  The file is written under a
+   *       temporary name unique to this call (mkstemp, same directory) and renamed into place, so
+   *       readers never see a partial file and concurrent writers never share a temporary.
+   * returns: true on success; false if a key appears twice or the file cannot be written.
+   * status:  DONE
+   */
+    static bool write(const char *path, const std::vector<Entry> &entries) {
+      std::vector<const Entry *> order;
+      for(size_t i=0; i<entries.size(); i++)
+        order.push_back(&entries[i]);
+      std::sort(order.begin(), order.end(), [](const Entry *x, const Entry *y) { return x->key < y->key; });
+      for(size_t i=1; i<order.size(); i++) {
+        if(order[i-1]->key == order[i]->key)
+          return false;
+      }
+
+      // lay the file out in memory, then write it in one go
+      uint64_t rec_bytes = 0, key_bytes = 0;
+      for(size_t i=0; i<order.size(); i++) {
+        rec_bytes += 16 * order[i]->options.size();
+        key_bytes += order[i]->key.size();
+      }
+      uint64_t dir_offset = sizeof(Header) + rec_bytes;
+      uint64_t keys_offset = dir_offset + sizeof(DirEntry) * order.size();
+      uint64_t size = keys_offset + pad8(key_bytes);
+      std::vector<char> buf(size, 0);
+
+      uint64_t rec = sizeof(Header), key = keys_offset;
+      for(size_t i=0; i<order.size(); i++) {
+        const Entry &e = *order[i];
+        DirEntry d = { rec, e.options.size(), key, (uint32_t)e.key.size(), e.flags };
+        for(size_t k=0; k<e.options.size(); k++) {
+          memcpy(&buf[rec], &e.options[k].first, 8);
+          memcpy(&buf[rec + 8], &e.options[k].second, 8);
+          rec += 16;
+        }
+        memcpy(&buf[dir_offset + i * sizeof(DirEntry)], &d, sizeof(DirEntry));
+        if(!e.key.empty())
+          memcpy(&buf[key], e.key.data(), e.key.size());
+        key += e.key.size();
+      }
+
+      Header h;
+      memset(&h, 0, sizeof(h));
+      memcpy(h.magic, magic(), 8);
+      h.version = VERSION;
+      h.count = (uint32_t)order.size();
+      h.dir_offset = dir_offset;
+      h.keys_offset = keys_offset;
+      h.file_size = size;
+      h.checksum = checksum(buf.data() + sizeof(Header), size - sizeof(Header));
+      memcpy(&buf[0], &h, sizeof(h));
+
+      std::string tmp = std::string(path) + ".XXXXXX";
+      int fd = mkstemp(&tmp[0]);
+      if(fd < 0)
+        return false;
+      FILE *f = fchmod(fd, 0644) == 0 ? fdopen(fd, "wb") : nullptr;
+      if(f == nullptr) {
+        close(fd);
+        remove(tmp.c_str());
+        return false;
+      }
+      bool ok = fwrite(&buf[0], 1, size, f) == size;
+      ok = (fclose(f) == 0) && ok;
+      if(!ok || rename(tmp.c_str(), path) != 0) {
+        remove(tmp.c_str());
+        return false;
+      }
+      return true;
+    }
+
+   /**
+   * func: open
+   * desc: maps the file read-only and checks its header and directory; with verify, the
+   *       checksum is checked too (one pass over the file).
+   * returns: pointer to the opened file (close it with delete); nullptr if the file is missing,
+   *       of another version, truncated or corrupt.
+   * RUNTIME:  O(number of frontiers) without verify; no options are read or copied
+   * status:  DONE
+   */
+    static FrontierFile * open(const char *path, bool verify=true) {
+      int fd = ::open(path, O_RDONLY);
+      struct stat st;
+
+      if(fd < 0)
+        return nullptr;
+      if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+        close(fd);
+        return nullptr;
+      }
+      void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if(m == MAP_FAILED)
+        return nullptr;
+
+      FrontierFile *f = new FrontierFile();
+      f->_base = (const char *)m;
+      f->_len = st.st_size;
+
+      const Header *h = (const Header *)f->_base;
+      if(memcmp(h->magic, magic(), 8) != 0 || h->version != VERSION || h->file_size != f->_len ||
+         f->_len % 8 != 0 || h->dir_offset > f->_len) {
+        delete f;
+        return nullptr;
+      }
+      f->_dir = (const DirEntry *)(f->_base + h->dir_offset);
+      f->_count = h->count;
+      if(!f->valid() ||
+         (verify && checksum(f->_base + sizeof(Header), f->_len - sizeof(Header)) != h->checksum)) {
+        delete f;
+        return nullptr;
+      }
+      return f;
+    }
+
+   /**
+   * func: count / key / frontier
+   * desc: number of frontiers in the file; the i-th route key and frontier (in key order)
+   * status:  DONE
+   */
+    int count() const { return (int)_count; }
+
+    std::string key(int i) const {
+      return std::string(_base + _dir[i].key_offset, _dir[i].key_len);
+    }
+
+    MappedOptions frontier(int i) const {
+      const DirEntry &e = _dir[i];
+      return MappedOptions((const double *)(_base + e.rec_offset), e.count, e.flags);
+    }
+
+   /**
+   * func: find
+   * desc: looks up the frontier saved under key
+   * returns: true and the frontier in out if there is one; false otherwise
+   * RUNTIME:  O(log(count)) key comparisons
+   * status:  DONE
+   */
+    bool find(const std::string &key, MappedOptions &out) const {
+      const DirEntry *e = std::lower_bound(_dir, _dir + _count, key,
+          [this](const DirEntry &d, const std::string &k) { return key_less(d, k); });
+      if(e == _dir + _count || std::string(_base + e->key_offset, e->key_len) != key)
+        return false;
+      out = frontier((int)(e - _dir));
+      return true;
+    }
+};
+
+#endif
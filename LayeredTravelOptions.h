@@ -0,0 +1,346 @@
+#ifndef _LAYERED_TRVL_OPTNS_H
+#define _LAYERED_TRVL_OPTNS_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "TravelOptions.h"
+
+/**
+ * LayeredTravelOptions:  a pareto frontier that keeps the options it dominates, so that erasing a
+ *   frontier option (a fare sells out) brings back the options it was hiding instead of needing a
+ *   rebuild from the raw feed.
+ *
+ * The options are peeled into pareto layers ("onion" layers):  layer 0 is the frontier of all
+ *   options, layer 1 the frontier of what is left without layer 0, and so on.  Each layer is a
+ *   pareto-sorted vector (strictly increasing price, strictly decreasing time), and every option
+ *   of layer k+1 is dominated by (or equal to) an option of layer k.  So
+ *     - an option belongs to the first layer that does not dominate it:  whether a layer dominates
+ *       <p,t> is one binary search (the last option with price <= p), and the answer is monotone
+ *       in the layer, so finding the layer is a binary search too (O(log^2 n));
+ *     - insert puts the option in its layer and pushes the options it dominates there (a
+ *       contiguous run) one layer down, where they push down the options they dominate, ...
+ *     - erase takes the option out of its layer and pulls up the options of the next layer that
+ *       only it dominated (a contiguous run between its two neighbours), which leave a gap in
+ *       their own layer that the layer below fills, ...
+ *   Each step touches only the run that moves (plus the vector splice), so an update costs
+ *   O(log^2 n + moved options) comparisons instead of a rebuild.
+ *
+ * Two equal options never share a layer:  the copy inserted second goes one layer down, and
+ *   erasing one copy promotes the other.  Options must not contain NaN.
+ */
+template <typename Price = double, typename Time = double>
+class BasicLayeredTravelOptions{
+
+  public:
+    typedef BasicTravelOptions<Price, Time> Options;
+    typedef std::pair<Price, Time> Option;
+    typedef std::vector<Option> Layer;
+
+  private:
+    std::vector<Layer> _layers;
+    size_t _size;
+
+    static bool price_less(const Option &o, Price p) {
+      return o.first < p;
+    }
+
+    static bool price_greater(Price p, const Option &o) {
+      return p < o.first;
+    }
+
+    static bool time_greater(const Option &o, Time t) {
+      return o.second >= t;
+    }
+
+    /**
+     * func: covered
+     * desc: private utility; whether layer k has an option <= <price,time> in both criteria.
+     *       pos is set to the number of options of the layer with price <= price.
+     */
+    bool covered(size_t k, Price price, Time time, size_t &pos) const {
+      const Layer &l = _layers[k];
+
+      pos = std::upper_bound(l.begin(), l.end(), price, price_greater) - l.begin();
+      return pos > 0 && l[pos-1].second <= time;
+    }
+
+    /**
+     * func: depth
+     * desc: private utility; the number of layers that cover <price,time> (they are always the
+     *       first ones), i.e. the layer the option goes to.
+     */
+    size_t depth(Price price, Time time) const {
+      size_t lo = 0, hi = _layers.size(), pos;
+
+      while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(covered(mid, price, time, pos))
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      return lo;
+    }
+
+    /**
+     * func: push_down
+     * desc: private engine; merges carry (options that just left layer k-1, pareto-sorted) into
+     *       layer k and carries the options they dominate on to the next layer.
+     */
+    void push_down(size_t k, Layer &carry) {
+      Layer merged, next;
+
+      while(!carry.empty()) {
+        if(k == _layers.size()) {
+          _layers.push_back(Layer());
+          _layers.back().swap(carry);
+          return;
+        }
+        Layer &l = _layers[k];
+
+        // only options with price >= the first carried price and time >= the last carried time
+        // can be dominated; they are a contiguous run of the layer
+        size_t lo = std::lower_bound(l.begin(), l.end(), carry.front().first, price_less) - l.begin();
+        size_t hi = std::lower_bound(l.begin() + lo, l.end(), carry.back().second, time_greater) - l.begin();
+
+        merged.clear();
+        next.clear();
+        size_t i = 0;
+        for(size_t j=lo; j<hi; j++) {
+          while(i < carry.size() && carry[i].first <= l[j].first)
+            merged.push_back(carry[i++]);
+          if(i > 0 && carry[i-1].second <= l[j].second)
+            next.push_back(l[j]);
+          else
+            merged.push_back(l[j]);
+        }
+        merged.insert(merged.end(), carry.begin() + i, carry.end());
+
+        l.erase(l.begin() + lo, l.begin() + hi);
+        l.insert(l.begin() + lo, merged.begin(), merged.end());
+        carry.swap(next);
+        k++;
+      }
+    }
+
+    /**
+     * func: pull_up
+     * desc: private engine; options were just removed from layer k at position gap (the options
+     *       before and after it are its neighbours); moves into the gap the options of layer k+1
+     *       that no option of layer k dominates any more, then fills the gap they leave, ...
+     */
+    void pull_up(size_t k, size_t gap) {
+      while(k + 1 < _layers.size()) {
+        Layer &l = _layers[k], &below = _layers[k+1];
+
+        // not dominated by the left neighbour:  faster than it; by the right one:  cheaper
+        size_t lo = 0, hi = below.size();
+        if(gap > 0)
+          lo = std::lower_bound(below.begin(), below.end(), l[gap-1].second, time_greater) - below.begin();
+        if(gap < l.size())
+          hi = std::lower_bound(below.begin(), below.end(), l[gap].first, price_less) - below.begin();
+        if(lo >= hi)
+          break;
+
+        l.insert(l.begin() + gap, below.begin() + lo, below.begin() + hi);
+        below.erase(below.begin() + lo, below.begin() + hi);
+        k++;
+        gap = lo;
+      }
+      while(!_layers.empty() && _layers.back().empty())
+        _layers.pop_back();
+    }
+
+  public:
+    BasicLayeredTravelOptions() : _size(0) {}
+
+   /**
+   * func: clear
+   * desc: Removes all options
+   * status:  DONE
+   */
+    void clear() {
+      _layers.clear();
+      _size = 0;
+    }
+
+   /**
+   * func: size / layers
+   * desc: the number of options (in all layers) / of layers
+   * status:  DONE
+   */
+    size_t size() const {
+      return _size;
+    }
+
+    size_t layers() const {
+      return _layers.size();
+    }
+
+   /**
+   * func: layer
+   * desc: the options of layer k, pareto-sorted; layer(0) is the frontier
+   * status:  DONE
+   */
+    const Layer & layer(size_t k) const {
+      return _layers[k];
+    }
+
+   /**
+   * func: assign
+   * desc: replaces the contents with the options in vec (any order, duplicates allowed)
+   * RUNTIME:  O(n log n):  after sorting, an option goes to the first layer whose fastest option
+   *           so far is slower than it (those times increase with the layer, so binary search)
+   * status:  DONE
+   */
+    void assign(const std::vector<Option> &vec) {
+      std::vector<Option> v(vec);
+      std::vector<Time> tail;   // time of the last option of each layer
+
+      clear();
+      std::sort(v.begin(), v.end());
+      for(size_t i=0; i<v.size(); i++) {
+        size_t k = std::upper_bound(tail.begin(), tail.end(), v[i].second) - tail.begin();
+        if(k == _layers.size()) {
+          _layers.push_back(Layer());
+          tail.push_back(v[i].second);
+        }
+        _layers[k].push_back(v[i]);
+        tail[k] = v[i].second;
+      }
+      _size = v.size();
+    }
+
+   /**
+   * func: insert
+   * desc: adds the option; if it makes it to the frontier, the frontier options it dominates move
+   *       down a layer (and so on, see top of file)
+   * RUNTIME:  O(log^2 n + options that move down), plus the vector splices
+   * status:  DONE
+   */
+    void insert(Price price, Time time) {
+      size_t k = depth(price, time);
+
+      _size++;
+      if(k == _layers.size()) {
+        _layers.push_back(Layer(1, Option(price, time)));
+        return;
+      }
+
+      // the options of layer k it dominates:  price >= price, and time >= time
+      Layer &l = _layers[k];
+      size_t lo = std::lower_bound(l.begin(), l.end(), price, price_less) - l.begin();
+      size_t hi = std::lower_bound(l.begin() + lo, l.end(), time, time_greater) - l.begin();
+      Layer carry(l.begin() + lo, l.begin() + hi);
+
+      l.erase(l.begin() + lo, l.begin() + hi);
+      l.insert(l.begin() + lo, Option(price, time));
+      push_down(k + 1, carry);
+    }
+
+   /**
+   * func: erase
+   * desc: removes one copy of the option; the options only it dominated move up a layer (so the
+   *       frontier is again the frontier of the options left), and so on down the layers
+   * returns: false if there is no such option
+   * RUNTIME:  O(log^2 n + options that move up), plus the vector splices
+   * status:  DONE
+   */
+    bool erase(Price price, Time time) {
+      size_t k = depth(price, time), pos;
+
+      // the last layer that covers the option holds it, if any does
+      if(k == 0)
+        return false;
+      k--;
+      covered(k, price, time, pos);
+      Layer &l = _layers[k];
+      if(!(l[pos-1].first == price && l[pos-1].second == time))
+        return false;
+
+      l.erase(l.begin() + (pos - 1));
+      _size--;
+      pull_up(k, pos - 1);
+      return true;
+    }
+
+   /**
+   * func: contains
+   * desc: whether the option is in the set (in any layer)
+   * RUNTIME:  O(log^2 n)
+   * status:  DONE
+   */
+    bool contains(Price price, Time time) const {
+      size_t k = depth(price, time), pos;
+
+      if(k == 0)
+        return false;
+      covered(k - 1, price, time, pos);
+      const Layer &l = _layers[k-1];
+      return l[pos-1].first == price && l[pos-1].second == time;
+    }
+
+   /**
+   * func: best_time_within_budget
+   * desc: the fastest option with price <= budget (see TravelOptions::best_time_within_budget)
+   * returns: true and the option in price/time if there is one; false otherwise
+   * RUNTIME:  O(log n)
+   * status:  DONE
+   */
+    bool best_time_within_budget(Price budget, Price &price, Time &time) const {
+      if(_layers.empty())
+        return false;
+      const Layer &l = _layers[0];
+      size_t k = std::upper_bound(l.begin(), l.end(), budget, price_greater) - l.begin();
+
+      if(k == 0)
+        return false;
+      price = l[k-1].first;
+      time = l[k-1].second;
+      return true;
+    }
+
+   /**
+   * func: frontier
+   * desc: copies layer 0 (the pareto-sorted frontier) into out
+   * RUNTIME:  O(f) for f frontier options
+   * status:  DONE
+   */
+    void frontier(Options &out) const {
+      if(_layers.empty())
+        out.clear();
+      else
+        Options::from_vec(_layers[0], out);
+    }
+
+   /**
+   * func: is_valid
+   * desc: checks the layer invariants (each layer pareto-sorted, each option of a layer covered by
+   *       the layer above, sizes add up); for tests and debugging
+   * RUNTIME:  O(n log n)
+   * status:  DONE
+   */
+    bool is_valid() const {
+      size_t n = 0, pos;
+
+      for(size_t k=0; k<_layers.size(); k++) {
+        const Layer &l = _layers[k];
+        if(l.empty())
+          return false;
+        for(size_t i=0; i<l.size(); i++) {
+          if(i > 0 && (l[i-1].first >= l[i].first || l[i-1].second <= l[i].second))
+            return false;
+          if(k > 0 && !covered(k - 1, l[i].first, l[i].second, pos))
+            return false;
+        }
+        n += l.size();
+      }
+      return n == _size;
+    }
+};
+
+typedef BasicLayeredTravelOptions<> LayeredTravelOptions;
+
+#endif
@@ -0,0 +1,325 @@
+#ifndef _ROUTE_PLANNER_H
+#define _ROUTE_PLANNER_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <cstdint>
+
+#include "TravelOptions.h"
+
+/**
+ * RoutePlanner:  all pareto-optimal <price,time> itineraries from one city to every other city of
+ *   a network of legs, where each leg (a directed edge between two cities) has its own frontier of
+ *   fares (e.g., a cheap slow bus and an expensive fast train).
+ *
+ * Legs:  add_leg stores the pareto-sorted frontier of the leg's fares; a second leg between the same
+ *   two cities is merged into the first with union_pareto_sorted.  Prices and times must be
+ *   non-negative.
+ *
+ * Search (Martins' multi-label-setting algorithm):  a label is one <price,time> way of reaching a
+ *   city.  Tentative labels sit in a priority queue in <price,time> order.  The smallest one is made
+ *   permanent unless a permanent label of its city dominates it, and is then extended over every
+ *   leg out of its city:  the plus-plus join of the label with the leg's frontier (one new label
+ *   per fare).  Because legs never make a label cheaper or faster, labels come out of the queue in
+ *   <price,time> order, so
+ *     - a label is dominated iff the last permanent label of its city is at least as fast (O(1));
+ *     - the permanent labels of a city are its frontier, already pareto-sorted.
+ *   New labels that a permanent label already dominates are dropped before they reach the queue,
+ *   and with a target city, so is every label no faster than the target's fastest permanent label
+ *   (it cannot lead to a new target option).
+ *
+ * Each permanent label remembers the label it was extended from, so itinerary() can list the legs
+ *   of any option of any city's frontier.
+ */
+template <typename Price = double, typename Time = double>
+class BasicRoutePlanner{
+
+  public:
+    typedef BasicTravelOptions<Price, Time> Options;
+
+    // one leg of an itinerary, with the fare taken
+    struct Leg {
+      int from, to;
+      Price price;
+      Time time;
+    };
+
+    // counters of the last plan
+    struct Stats {
+      uint64_t pushed;     // labels that went into the queue
+      uint64_t settled;    // labels made permanent (the sizes of all frontiers)
+      uint64_t pruned;     // labels dropped as dominated (before or after the queue)
+    };
+
+  private:
+    struct Edge {
+      int to;
+      Options fares;   // pareto-sorted
+    };
+
+    struct Label {
+      Price price;
+      Time time;
+      int city;
+      int parent;      // label this one was extended from; -1 at the source
+      int fare;        // index into _fares of the fare taken from the parent
+    };
+
+    // queue entry:  <price, time> first, so the queue pops labels in <price,time> order
+    typedef std::pair<std::pair<Price, Time>, int> Entry;
+
+    std::vector<std::vector<Edge>> _out;
+    int _legs;
+
+    // flat copy of the legs for the search (rebuilt after add_leg)
+    std::vector<int> _first;                        // legs out of city c are _first[c].._first[c+1]-1
+    std::vector<int> _to;
+    std::vector<int> _fare;                         // fares of leg i are _fare[i].._fare[i+1]-1
+    std::vector<std::pair<Price, Time>> _fares;
+    bool _flat;
+
+    // results of the last plan
+    std::vector<Label> _labels;
+    std::vector<std::vector<int>> _settled;        // permanent labels per city, pareto-sorted
+    std::vector<Options> _frontier;
+    Stats _stats;
+
+    /**
+     * func: flatten
+     * desc: private utility; copies the legs into the contiguous arrays the search walks.
+     */
+    void flatten() {
+      std::vector<std::pair<Price, Time>> v;
+
+      _first.assign(1, 0);
+      _to.clear();
+      _fare.assign(1, 0);
+      _fares.clear();
+      for(size_t c=0; c<_out.size(); c++) {
+        for(size_t i=0; i<_out[c].size(); i++) {
+          _out[c][i].fares.to_vec(v);
+          _to.push_back(_out[c][i].to);
+          _fares.insert(_fares.end(), v.begin(), v.end());
+          _fare.push_back((int)_fares.size());
+        }
+        _first.push_back((int)_to.size());
+      }
+      _flat = true;
+    }
+
+    /**
+     * func: fastest
+     * desc: private utility; time of the last (fastest) permanent label of city c.
+     * returns: false if c has no permanent label yet
+     */
+    bool fastest(int c, Time &time) const {
+      if(_settled[c].empty())
+        return false;
+      time = _labels[_settled[c].back()].time;
+      return true;
+    }
+
+    /**
+     * func: search
+     * desc: private engine; the label-setting search from source (see top of file).  target < 0
+     *       means every city.
+     * returns: false if a total does not fit Price / Time (integer types only)
+     */
+    bool search(int source, int target) {
+      std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+      if(!_flat)
+        flatten();
+      _labels.clear();
+      _settled.assign(_out.size(), std::vector<int>());
+      _frontier.assign(_out.size(), Options());
+      _stats.pushed = 0;
+      _stats.settled = 0;
+      _stats.pruned = 0;
+
+      Label start = { Price(), Time(), source, -1, -1 };
+      _labels.push_back(start);
+      queue.push(Entry(std::make_pair(start.price, start.time), 0));
+      _stats.pushed++;
+
+      while(!queue.empty()) {
+        int id = queue.top().second;
+        queue.pop();
+
+        Label l = _labels[id];
+        Time best;
+        if((fastest(l.city, best) && best <= l.time) ||
+           (target >= 0 && l.city != target && fastest(target, best) && best <= l.time)) {
+          _stats.pruned++;
+          continue;
+        }
+        _settled[l.city].push_back(id);
+        _stats.settled++;
+
+        for(int e = _first[l.city]; e < _first[l.city + 1]; e++) {
+          int to = _to[e];
+          for(int f = _fare[e]; f < _fare[e + 1]; f++) {
+            Label n = { Price(), Time(), to, id, f };
+            if(!option_sum<Price>::add(l.price, _fares[f].first, n.price) ||
+               !option_sum<Time>::add(l.time, _fares[f].second, n.time))
+              return false;
+            if((fastest(to, best) && best <= n.time) ||
+               (target >= 0 && fastest(target, best) && best <= n.time)) {
+              _stats.pruned++;
+              continue;
+            }
+            _labels.push_back(n);
+            queue.push(Entry(std::make_pair(n.price, n.time), (int)_labels.size() - 1));
+            _stats.pushed++;
+          }
+        }
+      }
+
+      std::vector<std::pair<Price, Time>> v;
+      for(size_t c=0; c<_out.size(); c++) {
+        v.clear();
+        for(size_t i=0; i<_settled[c].size(); i++)
+          v.push_back(std::make_pair(_labels[_settled[c][i]].price, _labels[_settled[c][i]].time));
+        Options::from_vec(v, _frontier[c]);
+      }
+      return true;
+    }
+
+  public:
+    explicit BasicRoutePlanner(int cities) : _out(cities), _legs(0), _flat(false) {
+      _settled.resize(cities);
+      _frontier.resize(cities);
+      _stats.pushed = 0;
+      _stats.settled = 0;
+      _stats.pruned = 0;
+    }
+
+   /**
+   * func: cities / legs
+   * desc: the number of cities / of distinct <from,to> legs
+   * status:  DONE
+   */
+    int cities() const {
+      return (int)_out.size();
+    }
+
+    int legs() const {
+      return _legs;
+    }
+
+   /**
+   * func: add_leg
+   * desc: adds the fares of a leg from city from to city to.  Dominated fares are dropped; if the
+   *       planner already has a leg from -> to, the two frontiers are merged (union_pareto_sorted).
+   * returns: false (and nothing is added) if a city is out of range or a price or time is negative
+   * RUNTIME:  O(f log f) for f fares, plus the out-degree of from
+   * status:  DONE
+   */
+    bool add_leg(int from, int to, const Options &fares) {
+      std::vector<std::pair<Price, Time>> v;
+
+      if(from < 0 || to < 0 || from >= cities() || to >= cities())
+        return false;
+      fares.to_vec(v);
+      for(size_t i=0; i<v.size(); i++) {
+        if(!(v[i].first >= Price()) || !(v[i].second >= Time()))
+          return false;
+      }
+
+      Options *f = Options::pareto_from_vec(v);
+      std::vector<Edge> &out = _out[from];
+      size_t i = 0;
+      while(i < out.size() && out[i].to != to)
+        i++;
+      if(i == out.size()) {
+        out.push_back(Edge());
+        out.back().to = to;
+        out.back().fares.swap(*f);
+        _legs++;
+      }
+      else {
+        out[i].fares.union_pareto_sorted(*f, out[i].fares);
+      }
+      delete f;
+      _flat = false;
+      return true;
+    }
+
+    bool add_leg(int from, int to, Price price, Time time) {
+      Options fare;
+      fare.push_front(price, time);
+      return add_leg(from, to, fare);
+    }
+
+   /**
+   * func: plan
+   * desc: computes the frontier of every city reachable from source (the source's is the single
+   *       option <0,0>); the results replace those of the previous plan.
+   * returns: false if source is out of range, or if a total does not fit Price / Time (integer
+   *       types only; the results are then incomplete)
+   * RUNTIME:  O(L log L) for L labels pushed; see stats()
+   * status:  DONE
+   */
+    bool plan(int source) {
+      if(source < 0 || source >= cities())
+        return false;
+      return search(source, -1);
+    }
+
+   /**
+   * func: plan (to one target)
+   * desc: same search, but only the frontier of target is wanted:  labels no faster than the
+   *       target's fastest option are dropped, which usually ends the search much earlier.  The
+   *       frontiers of the other cities are then incomplete.
+   * status:  DONE
+   */
+    bool plan(int source, int target) {
+      if(source < 0 || source >= cities() || target < 0 || target >= cities())
+        return false;
+      return search(source, target);
+    }
+
+   /**
+   * func: frontier
+   * desc: the pareto-sorted options from the last plan's source to city (empty if unreachable)
+   * status:  DONE
+   */
+    const Options & frontier(int city) const {
+      return _frontier[city];
+    }
+
+   /**
+   * func: itinerary
+   * desc: the legs (in travel order) of the k-th option of frontier(city)
+   * returns: false if there is no such option
+   * status:  DONE
+   */
+    bool itinerary(int city, int k, std::vector<Leg> &legs) const {
+      legs.clear();
+      if(city < 0 || city >= cities() || k < 0 || k >= (int)_settled[city].size())
+        return false;
+      for(int id = _settled[city][k]; _labels[id].parent >= 0; id = _labels[id].parent) {
+        const Label &l = _labels[id];
+        Leg leg = { _labels[l.parent].city, l.city, _fares[l.fare].first, _fares[l.fare].second };
+        legs.push_back(leg);
+      }
+      std::reverse(legs.begin(), legs.end());
+      return true;
+    }
+
+   /**
+   * func: stats
+   * desc: label counters of the last plan
+   * status:  DONE
+   */
+    const Stats & stats() const {
+      return _stats;
+    }
+};
+
+typedef BasicRoutePlanner<> RoutePlanner;
+
+#endif
@@ -0,0 +1,334 @@
+#ifndef _SKYLINE_H
+#define _SKYLINE_H
+
+#include <vector>
+#include <array>
+#include <utility>
+#include <algorithm>
+#include <cstdio>
+
+#include "TravelOptions.h"
+
+/**
+ * SkylineOptions<D, V>:  options with D criteria (e.g., price, time, transfers, CO2), all of type V
+ *   and all "smaller is better".  The two-criteria TravelOptions operations carried over to D
+ *   criteria:  dominance compare, pareto check, prune, union and the joins, where each criterion
+ *   gets its own combiner (a two-leg trip adds prices and transfers, two parallel trips take the
+ *   MAX of the times, ...).
+ *
+ * Options are stored contiguously (one std::array per option).  Every operation that produces a
+ *   pareto set goes through skyline(), a sort-filter-skyline (SFS):  options are sorted so that no
+ *   option can be dominated by a later one, then kept iff no option kept so far covers them.  Each
+ *   option is only compared against the skyline (not against all n options), and for D == 2 the
+ *   filter is the usual O(n log n) sweep.
+ *
+ * A pareto set here has no two options where one is better than or equal to the other (as in
+ *   TravelOptions); "sorted" is lexicographic order of the criteria.  Options must not contain NaN.
+ */
+template <size_t D, typename V = double>
+class SkylineOptions{
+
+  public:
+    typedef std::array<V, D> Option;
+    typedef TravelOptions::Relationship Relationship;
+
+    // how a join combines one criterion of the two options
+    enum Combine { SUM, MAX, MIN };
+    typedef std::array<Combine, D> Combiners;
+
+  private:
+    std::vector<Option> _opts;
+    mutable bool _pareto_sorted;   // known to be pareto and sorted (false = not known)
+
+  public:
+    // constructors
+    SkylineOptions() {
+      _pareto_sorted = true;
+    }
+
+   /**
+   * func: clear
+   * desc: Removes all options
+   * status:  DONE
+   */
+    void clear(){
+      _opts.clear();
+      _pareto_sorted = true;
+    }
+
+   /**
+   * func: size
+   * desc: returns the number of options
+   * status:  DONE
+   */
+    int size( ) const {
+      return (int)_opts.size();
+    }
+
+   /**
+   * func: option
+   * desc: read access to the i-th option
+   * status:  DONE
+   */
+    const Option & option(int i) const {
+      return _opts[i];
+    }
+
+   /**
+   * func: compare
+   * desc: same rules as TravelOptions::compare, over all D criteria:
+   *         equal         every criterion is equal
+   *         better        otherwise, A is no worse than B in every criterion
+   *         worse         otherwise, A is no better than B in every criterion
+   *         incomparable  everything else
+   * RUNTIME:  O(D)
+   * status:  DONE
+   */
+    static Relationship compare(const Option &a, const Option &b) {
+      bool le = true, ge = true;
+
+      for(size_t k=0; k<D; k++) {
+        le = le && a[k] <= b[k];
+        ge = ge && a[k] >= b[k];
+      }
+      if(le && ge)
+        return TravelOptions::equal;
+      if(le)
+        return TravelOptions::better;
+      if(ge)
+        return TravelOptions::worse;
+      return TravelOptions::incomparable;
+    }
+
+   /**
+   * func: push_back
+   * desc: Adds an option at the end of the list
+   * status:  DONE
+   */
+    void push_back(const Option &o) {
+      _opts.push_back(o);
+      _pareto_sorted = _opts.size() == 1;
+    }
+
+   /**
+   * func: from_vec / to_vec
+   * desc: builds a new object with the given options (same order) / copies the options into a
+   *       new vector
+   * status:  DONE
+   */
+    static SkylineOptions * from_vec(const std::vector<Option> &vec) {
+      SkylineOptions *s = new SkylineOptions();
+      s->_opts = vec;
+      s->_pareto_sorted = vec.size() <= 1;
+      return s;
+    }
+
+    std::vector<Option> * to_vec() const {
+      return new std::vector<Option>(_opts);
+    }
+
+   /**
+   * func: is_pareto
+   * desc: true iff no option is better than or equal to another
+   * RUNTIME:  one skyline() of a copy (see top of file)
+   * status:  DONE
+   */
+    bool is_pareto() const {
+      if(_pareto_sorted)
+        return true;
+      std::vector<Option> buf(_opts);
+      skyline(buf);
+      return buf.size() == _opts.size();
+    }
+
+   /**
+   * func: is_pareto_sorted
+   * desc: true iff the options are pareto and in lexicographic order
+   * status:  DONE
+   */
+    bool is_pareto_sorted() const {
+      if(!_pareto_sorted)
+        _pareto_sorted = std::is_sorted(_opts.begin(), _opts.end()) && is_pareto();
+      return _pareto_sorted;
+    }
+
+   /**
+   * func: prune
+   * desc: removes every option that some other option is better than or equal to (for duplicates,
+   *       one copy stays); the survivors end up sorted.  Unlike TravelOptions::prune_sorted, the
+   *       list does not need to be sorted first.
+   * returns: true
+   * RUNTIME:  O(n log n) sort plus the filter (see top of file)
+   * status:  DONE
+   */
+    bool prune() {
+      if(!_pareto_sorted) {
+        skyline(_opts);
+        _pareto_sorted = true;
+      }
+      return true;
+    }
+
+   /**
+   * func: union_pareto
+   * desc: the pareto-sorted union of the two option sets as a newly created object (neither input
+   *       needs to be pareto or sorted)
+   * status:  DONE
+   */
+    SkylineOptions * union_pareto(const SkylineOptions &other) const {
+      SkylineOptions *s = new SkylineOptions();
+
+      s->_opts.reserve(_opts.size() + other._opts.size());
+      s->_opts.insert(s->_opts.end(), _opts.begin(), _opts.end());
+      s->_opts.insert(s->_opts.end(), other._opts.begin(), other._opts.end());
+      skyline(s->_opts);
+      return s;
+    }
+
+   /**
+   * func: join
+   * desc: every pairing of an option a (calling object) with an option b (parameter) gives the option
+   *       c with c[k] = how[k](a[k], b[k]) (SUM, MAX or MIN).  Returns the pareto-sorted set of those
+   *       options.  With how all SUM this is join_plus_plus (legs in series); {SUM, MAX} is
+   *       join_plus_max of TravelOptions.
+   *
+   *       All three combiners are monotone, so a dominated input option only produces dominated
+   *       pairings:  both inputs are pruned first, and only their skylines are paired.
+   * returns: pointer to a new pareto-sorted object; nullptr if V is an integer type and a SUM does
+   *       not fit it (as in TravelOptions::join_plus_plus).
+   * RUNTIME:  O(s1 s2) pairings for skylines of s1 and s2 options, then one skyline()
+   * status:  DONE
+   */
+    SkylineOptions * join(const SkylineOptions &other, const Combiners &how) const {
+      std::vector<Option> a(_opts), b(other._opts);
+      SkylineOptions *s = new SkylineOptions();
+
+      if(!_pareto_sorted)
+        skyline(a);
+      if(!other._pareto_sorted)
+        skyline(b);
+      s->_opts.reserve(a.size() * b.size());
+      for(size_t i=0; i<a.size(); i++) {
+        for(size_t j=0; j<b.size(); j++) {
+          Option c;
+          for(size_t k=0; k<D; k++) {
+            if(how[k] == MAX)
+              c[k] = std::max(a[i][k], b[j][k]);
+            else if(how[k] == MIN)
+              c[k] = std::min(a[i][k], b[j][k]);
+            else if(!option_sum<V>::add(a[i][k], b[j][k], c[k])) {
+              delete s;
+              return nullptr;
+            }
+          }
+          s->_opts.push_back(c);
+        }
+      }
+      skyline(s->_opts);
+      return s;
+    }
+
+   /**
+   * func: join_plus_plus
+   * desc: join with every criterion added (see join)
+   * status:  DONE
+   */
+    SkylineOptions * join_plus_plus(const SkylineOptions &other) const {
+      return join(other, all(SUM));
+    }
+
+   /**
+   * func: all
+   * desc: the same combiner for every criterion
+   * status:  DONE
+   */
+    static Combiners all(Combine c) {
+      Combiners how;
+      how.fill(c);
+      return how;
+    }
+
+   /**
+   * func: display
+   * desc: prints a string representation of the current object
+   * status:  DONE
+   */
+    void display() const {
+      for(size_t i=0; i<_opts.size(); i++) {
+        for(size_t k=0; k<D; k++)
+          printf("   %8.2f", (double)_opts[i][k]);
+        printf("\n");
+      }
+    }
+
+  private:
+
+   /**
+   * func: covers
+   * desc: private utility; true iff a is better than or equal to b (b is useless next to a)
+   * status:  DONE
+   */
+    static bool covers(const Option &a, const Option &b) {
+      for(size_t k=0; k<D; k++) {
+        if(a[k] > b[k])
+          return false;
+      }
+      return true;
+    }
+
+   /**
+   * func: skyline
+   * desc: private engine; replaces buf with its pareto-sorted skyline.
+   *
+   *       D == 2:  sort, then keep each option strictly better in the second criterion than the
+   *       last one kept (the TravelOptions sweep).
+   *
+   *       D > 2 (sort-filter-skyline):  options are sorted by the sum of their criteria, ties broken
+   *       lexicographically.  If a covers b then a's sum is no larger (rounded sums are monotone
+   *       too) and a sorts first, so by the time b is reached everything that could cover it has
+   *       already been seen; b is kept iff no kept option covers it.  Sorting by sum puts options
+   *       that are good overall (the ones that cover a lot) first, which keeps the scans short.
+   *       The survivors are sorted lexicographically at the end.
+   * RUNTIME:  O(n log n) for D == 2; O(n log n + n s D) for a skyline of s options otherwise
+   * status:  DONE
+   */
+    static void skyline(std::vector<Option> &buf) {
+      size_t kept = 0;
+
+      if(D == 2) {
+        std::sort(buf.begin(), buf.end());
+        for(size_t i=0; i<buf.size(); i++) {
+          if(kept == 0 || buf[i][D-1] < buf[kept-1][D-1])
+            buf[kept++] = buf[i];
+        }
+        buf.resize(kept);
+        return;
+      }
+
+      std::vector<std::pair<double, size_t>> order(buf.size());
+      for(size_t i=0; i<buf.size(); i++) {
+        double sum = 0;
+        for(size_t k=0; k<D; k++)
+          sum += (double)buf[i][k];
+        order[i] = std::make_pair(sum, i);
+      }
+      std::sort(order.begin(), order.end(),
+                [&buf](const std::pair<double, size_t> &x, const std::pair<double, size_t> &y) {
+        return x.first < y.first || (x.first == y.first && buf[x.second] < buf[y.second]);
+      });
+
+      std::vector<Option> sky;
+      for(size_t i=0; i<order.size(); i++) {
+        const Option &o = buf[order[i].second];
+        bool covered = false;
+        for(size_t j=0; j<sky.size() && !covered; j++)
+          covered = covers(sky[j], o);
+        if(!covered)
+          sky.push_back(o);
+      }
+      std::sort(sky.begin(), sky.end());
+      buf.swap(sky);
+    }
+};
+
+#endif
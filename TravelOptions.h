@@ -0,0 +1,10 @@
+#ifndef _TRVL_OPTNS_FWD_H
+#define _TRVL_OPTNS_FWD_H
+
+/*
+ * TravelOptions.h:  the name every driver and helper header includes.  The class itself lives in
+ *   proj1.cpp (the assignment's file), which is a header in all but name.
+ */
+#include "proj1.cpp"
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef _TRVL_STATS_H
+#define _TRVL_STATS_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifdef TRVL_STATS
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#endif
+
+/*
+ * trvl_stats:  opt-in instrumentation of the TravelOptions operations.  Build with -DTRVL_STATS to
+ *   turn it on; without it the TRVL_STAT_* hooks in TravelOptions.h expand to nothing, so a normal
+ *   build pays nothing (no counters, no clock reads, no thread-local lookups).
+ *
+ * Per operation (join_plus_plus, union_pareto_sorted, the bounded queries, the is_* precondition
+ *   scans, ...) it keeps the number of calls, the wall time, a latency histogram and five counters:
+ *     nodes_visited    list nodes (or vector slots) read
+ *     compares         option-vs-option dominance / order tests
+ *     nodes_allocated  nodes taken from the node pool
+ *     nodes_freed      nodes given back
+ *     pruned           options dropped as dominated (or, for prune_epsilon, as covered)
+ *
+ * Operations nest:  the counters go to the innermost operation running on the thread, so a hidden
+ *   is_pareto_sorted() scan inside union_pareto_sorted shows up under scan_pareto_sorted, while the
+ *   union's wall time includes it.  Work outside any operation (push_front, clear, ...) and work
+ *   on join_plus_plus_parallel's helper threads is counted under "other".
+ *
+ * Every thread writes its own table (plain relaxed stores, no locks, no atomic read-modify-write);
+ *   snapshot() sums the tables of all live threads plus those of threads that have exited.
+ *   A histogram bucket b counts the calls that took less than 2^b ns (and at least 2^(b-1)).
+ */
+namespace trvl_stats {
+
+  enum Op { OTHER, FROM_VEC, PARETO_FROM_VEC, INSERT_SORTED, INSERT_PARETO_SORTED,
+            INSERT_PARETO_SORTED_BATCH, UNION_PARETO_SORTED, UNION_PARETO_SORTED_K, PRUNE_SORTED,
+            PRUNE_EPSILON, JOIN_PLUS_PLUS, JOIN_PLUS_PLUS_EPSILON, JOIN_PLUS_PLUS_PARALLEL,
+            JOIN_VIEW, JOIN_PLUS_MAX, CHAIN_PLUS_PLUS, CHAIN_PLUS_MAX, SORT_IN_PLACE,
+            SORT_AND_PRUNE_IN_PLACE, SORTED_CLONE, SPLIT_SORTED_PARETO, BEST_TIME_WITHIN_BUDGET,
+            CHEAPEST_WITHIN_TIME, RANGE, SCAN_SORTED, SCAN_PARETO, SCAN_PARETO_SORTED, BUILD_INDEX, OPS };
+
+  enum Counter { NODES_VISITED, COMPARES, NODES_ALLOCATED, NODES_FREED, PRUNED, COUNTERS };
+
+  enum { BUCKETS = 40 };
+
+  inline const char * op_name(int op) {
+    static const char *names[OPS] = {
+      "other", "from_vec", "pareto_from_vec", "insert_sorted", "insert_pareto_sorted",
+      "insert_pareto_sorted_batch", "union_pareto_sorted", "union_pareto_sorted_k", "prune_sorted",
+      "prune_epsilon", "join_plus_plus", "join_plus_plus_epsilon", "join_plus_plus_parallel",
+      "join_view", "join_plus_max", "chain_plus_plus", "chain_plus_max", "sort_in_place",
+      "sort_and_prune_in_place", "sorted_clone", "split_sorted_pareto", "best_time_within_budget",
+      "cheapest_within_time", "range", "scan_sorted", "scan_pareto", "scan_pareto_sorted", "build_index" };
+    return names[op];
+  }
+
+  inline const char * counter_name(int c) {
+    static const char *names[COUNTERS] = {
+      "nodes_visited", "compares", "nodes_allocated", "nodes_freed", "pruned" };
+    return names[c];
+  }
+
+  // plain sums (what snapshot() returns)
+  struct Totals {
+    uint64_t calls[OPS];
+    uint64_t ns[OPS];
+    uint64_t counters[OPS][COUNTERS];
+    uint64_t hist[OPS][BUCKETS];
+
+    Totals() {
+      std::fill(&calls[0], &calls[0] + OPS, 0);
+      std::fill(&ns[0], &ns[0] + OPS, 0);
+      std::fill(&counters[0][0], &counters[0][0] + OPS * COUNTERS, 0);
+      std::fill(&hist[0][0], &hist[0][0] + OPS * BUCKETS, 0);
+    }
+
+    bool used(int op) const {
+      if(calls[op] != 0)
+        return true;
+      for(int c=0; c<COUNTERS; c++) {
+        if(counters[op][c] != 0)
+          return true;
+      }
+      return false;
+    }
+  };
+
+#ifdef TRVL_STATS
+
+  inline bool enabled() { return true; }
+
+  // one thread's counters; only the owning thread stores to it
+  struct Table {
+    std::atomic<uint64_t> calls[OPS];
+    std::atomic<uint64_t> ns[OPS];
+    std::atomic<uint64_t> counters[OPS][COUNTERS];
+    std::atomic<uint64_t> hist[OPS][BUCKETS];
+    int current;   // innermost operation running on the thread
+
+    Table() : current(OTHER) {
+      for(int op=0; op<OPS; op++) {
+        calls[op].store(0);
+        ns[op].store(0);
+        for(int c=0; c<COUNTERS; c++)
+          counters[op][c].store(0);
+        for(int b=0; b<BUCKETS; b++)
+          hist[op][b].store(0);
+      }
+    }
+
+    static void bump(std::atomic<uint64_t> &x, uint64_t n) {
+      x.store(x.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void add_to(Totals &t) const {
+      for(int op=0; op<OPS; op++) {
+        t.calls[op] += calls[op].load(std::memory_order_relaxed);
+        t.ns[op] += ns[op].load(std::memory_order_relaxed);
+        for(int c=0; c<COUNTERS; c++)
+          t.counters[op][c] += counters[op][c].load(std::memory_order_relaxed);
+        for(int b=0; b<BUCKETS; b++)
+          t.hist[op][b] += hist[op][b].load(std::memory_order_relaxed);
+      }
+    }
+  };
+
+  // live tables, plus the sums of exited threads and the reset() baseline (never destroyed)
+  struct Registry {
+    std::mutex lock;
+    std::vector<Table *> live;
+    Totals retired;
+    Totals baseline;
+  };
+
+  inline Registry & registry() {
+    static Registry *r = new Registry();
+    return *r;
+  }
+
+  // folds the thread's table into retired when the thread exits
+  struct Reaper {
+    Table *table;
+
+    ~Reaper();
+  };
+
+  inline Table *& tls() {
+    static thread_local Table *t = nullptr;
+    return t;
+  }
+
+  // the calling thread's table (created and registered on first use)
+  inline Table & local() {
+    Table *&t = tls();
+    if(t == nullptr) {
+      static thread_local bool exited = false;
+      static Table *orphans = new Table();   // writes after a thread's tables were torn down
+      if(exited)
+        return *orphans;
+      t = new Table();
+      Registry &r = registry();
+      {
+        std::lock_guard<std::mutex> g(r.lock);
+        r.live.push_back(t);
+      }
+      static thread_local Reaper reaper = { nullptr };
+      reaper.table = t;
+      struct Mark { bool &flag; ~Mark() { flag = true; } };
+      static thread_local Mark mark = { exited };
+      (void)mark;
+    }
+    return *t;
+  }
+
+  inline Reaper::~Reaper() {
+    if(table == nullptr)
+      return;
+    Registry &r = registry();
+    std::lock_guard<std::mutex> g(r.lock);
+    table->add_to(r.retired);
+    r.live.erase(std::find(r.live.begin(), r.live.end(), table));
+    delete table;
+    tls() = nullptr;
+  }
+
+  inline void count(Counter c, uint64_t n) {
+    Table &t = local();
+    Table::bump(t.counters[t.current][c], n);
+  }
+
+  // times one call of op (RAII) and makes it the thread's current operation
+  class Scope {
+      Table &_t;
+      int _op, _outer;
+      std::chrono::steady_clock::time_point _t0;
+
+    public:
+      explicit Scope(Op op) : _t(local()), _op(op), _outer(_t.current), _t0(std::chrono::steady_clock::now()) {
+        _t.current = op;
+      }
+
+      ~Scope() {
+        uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - _t0).count();
+        int b = 0;
+        while(b < BUCKETS - 1 && (ns >> b) != 0)
+          b++;
+        Table::bump(_t.calls[_op], 1);
+        Table::bump(_t.ns[_op], ns);
+        Table::bump(_t.hist[_op][b], 1);
+        _t.current = _outer;
+      }
+
+      Scope(const Scope &) = delete;
+      Scope & operator=(const Scope &) = delete;
+  };
+
+  // everything counted since the start (or the last reset)
+  inline Totals snapshot() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> g(r.lock);
+    Totals t = r.retired;
+    for(size_t i=0; i<r.live.size(); i++)
+      r.live[i]->add_to(t);
+    for(int op=0; op<OPS; op++) {
+      t.calls[op] -= r.baseline.calls[op];
+      t.ns[op] -= r.baseline.ns[op];
+      for(int c=0; c<COUNTERS; c++)
+        t.counters[op][c] -= r.baseline.counters[op][c];
+      for(int b=0; b<BUCKETS; b++)
+        t.hist[op][b] -= r.baseline.hist[op][b];
+    }
+    return t;
+  }
+
+  // starts counting from zero (tables are never cleared under their owners:  the current sums
+  //   become the baseline that snapshot() subtracts)
+  inline void reset() {
+    Totals now = snapshot();
+    Registry &r = registry();
+    std::lock_guard<std::mutex> g(r.lock);
+    for(int op=0; op<OPS; op++) {
+      r.baseline.calls[op] += now.calls[op];
+      r.baseline.ns[op] += now.ns[op];
+      for(int c=0; c<COUNTERS; c++)
+        r.baseline.counters[op][c] += now.counters[op][c];
+      for(int b=0; b<BUCKETS; b++)
+        r.baseline.hist[op][b] += now.hist[op][b];
+    }
+  }
+
+#define TRVL_STAT_OP(op) trvl_stats::Scope trvl_stat_scope_(trvl_stats::op)
+#define TRVL_STAT(counter, n) trvl_stats::count(trvl_stats::counter, (uint64_t)(n))
+
+#else
+
+  inline bool enabled() { return false; }
+  inline Totals snapshot() { return Totals(); }
+  inline void reset() {}
+
+#define TRVL_STAT_OP(op) ((void)0)
+#define TRVL_STAT(counter, n) ((void)0)
+
+#endif
+
+  /**
+   * func: to_json
+   * desc: the operations that were used, as
+   *         {"enabled": true, "ops": [{"op": "join_plus_plus", "calls": 3, "seconds": 0.0012,
+   *           "nodes_visited": 120, ..., "histogram": [{"le_ns": 1024, "count": 2}, ...]}, ...]}
+   *       (only non-empty histogram buckets are listed)
+   */
+  inline std::string to_json(const Totals &t) {
+    std::string s = enabled() ? "{\"enabled\": true, \"ops\": [" : "{\"enabled\": false, \"ops\": [";
+    char buf[128];
+    bool first = true;
+
+    for(int op=0; op<OPS; op++) {
+      if(!t.used(op))
+        continue;
+      snprintf(buf, sizeof(buf), "%s\n  {\"op\": \"%s\", \"calls\": %llu, \"seconds\": %.9f",
+               first ? "" : ",", op_name(op), (unsigned long long)t.calls[op], t.ns[op] * 1e-9);
+      s += buf;
+      first = false;
+      for(int c=0; c<COUNTERS; c++) {
+        snprintf(buf, sizeof(buf), ", \"%s\": %llu", counter_name(c), (unsigned long long)t.counters[op][c]);
+        s += buf;
+      }
+      s += ", \"histogram\": [";
+      bool firstb = true;
+      for(int b=0; b<BUCKETS; b++) {
+        if(t.hist[op][b] == 0)
+          continue;
+        snprintf(buf, sizeof(buf), "%s{\"le_ns\": %llu, \"count\": %llu}", firstb ? "" : ", ",
+                 1ULL << b, (unsigned long long)t.hist[op][b]);
+        s += buf;
+        firstb = false;
+      }
+      s += "]}";
+    }
+    s += first ? "]}\n" : "\n]}\n";
+    return s;
+  }
+
+  /**
+   * func: to_prometheus
+   * desc: the same numbers in the Prometheus text format:  one counter family per counter
+   *       (trvl_op_calls_total, trvl_op_nodes_visited_total, ...) and the latency histogram
+   *       trvl_op_seconds, all labelled by op
+   */
+  inline std::string to_prometheus(const Totals &t) {
+    std::string s;
+    char buf[160];
+
+    if(!enabled())
+      return "# trvl_stats disabled (build with -DTRVL_STATS)\n";
+
+    s += "# TYPE trvl_op_calls_total counter\n";
+    for(int op=0; op<OPS; op++) {
+      if(t.used(op)) {
+        snprintf(buf, sizeof(buf), "trvl_op_calls_total{op=\"%s\"} %llu\n", op_name(op),
+                 (unsigned long long)t.calls[op]);
+        s += buf;
+      }
+    }
+    for(int c=0; c<COUNTERS; c++) {
+      snprintf(buf, sizeof(buf), "# TYPE trvl_op_%s_total counter\n", counter_name(c));
+      s += buf;
+      for(int op=0; op<OPS; op++) {
+        if(t.used(op)) {
+          snprintf(buf, sizeof(buf), "trvl_op_%s_total{op=\"%s\"} %llu\n", counter_name(c), op_name(op),
+                   (unsigned long long)t.counters[op][c]);
+          s += buf;
+        }
+      }
+    }
+    s += "# TYPE trvl_op_seconds histogram\n";
+    for(int op=0; op<OPS; op++) {
+      if(t.calls[op] == 0)
+        continue;
+      uint64_t cum = 0;
+      for(int b=0; b<BUCKETS; b++) {
+        cum += t.hist[op][b];
+        if(t.hist[op][b] == 0)
+          continue;
+        snprintf(buf, sizeof(buf), "trvl_op_seconds_bucket{op=\"%s\",le=\"%.9g\"} %llu\n", op_name(op),
+                 (double)(1ULL << b) * 1e-9, (unsigned long long)cum);
+        s += buf;
+      }
+      snprintf(buf, sizeof(buf), "trvl_op_seconds_bucket{op=\"%s\",le=\"+Inf\"} %llu\n", op_name(op),
+               (unsigned long long)t.calls[op]);
+      s += buf;
+      snprintf(buf, sizeof(buf), "trvl_op_seconds_sum{op=\"%s\"} %.9f\n", op_name(op), t.ns[op] * 1e-9);
+      s += buf;
+      snprintf(buf, sizeof(buf), "trvl_op_seconds_count{op=\"%s\"} %llu\n", op_name(op),
+               (unsigned long long)t.calls[op]);
+      s += buf;
+    }
+    return s;
+  }
+
+  // snapshot() in either format
+  inline std::string json() { return to_json(snapshot()); }
+  inline std::string prometheus() { return to_prometheus(snapshot()); }
+}
+
+#endif
@@ -0,0 +1,639 @@
+#include "TravelOptions.h"
+#include "ConcurrentTravelOptions.h"
+#include "FareIngest.h"
+#include "RoutePlanner.h"
+#include "LayeredTravelOptions.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cmath>
+
+// using namespace std;
+
+/*
+ performance suite for TravelOptions.
+
+to compile:  g++ -std=c++11 -O2 -pthread bench.cpp
+to run:      ./a.out [options]
+
+   --json=FILE     also write the results to FILE as JSON (same layout as
+                   Google Benchmark's --benchmark_out, plus p50/p99 latency)
+   --filter=TEXT   only run benchmarks whose name contains TEXT
+   --max_n=N       largest list size (sizes go 10, 100, ... up to 1000000)
+   --pareto=D      fraction of the generated options that are on the
+                   pareto frontier (default 0.5)
+   --dup=R         fraction of the generated options that are duplicates
+                   of other options (default 0.1)
+   --min_time=S    keep repeating each benchmark for at least S seconds
+                   (default 0.2)
+   --seed=N        random seed (default 42)
+   --stats=FILE    write the per-operation counters and latency histograms
+                   (trvl_stats::json(), see TravelStats.h) to FILE; needs a
+                   build with -DTRVL_STATS
+
+ purpose:  every benchmark is run on synthetic lists of each size.  Setup
+             (building the input lists) is not timed; each iteration times
+             exactly one call of the operation.  For each <operation, size>
+             the suite reports iterations, mean / p50 / p99 latency and
+             throughput in options per second.
+
+             join_plus_plus_brute is the original brute-force join (every
+             pairing through insert_pareto_sorted), kept as the baseline for
+             join_plus_plus.  join_plus_plus_parallel uses one thread per
+             hardware thread.  prune_epsilon and join_plus_plus_epsilon use
+             eps = 0.01 for price and time.  concurrent_read / mutex_read
+             are the multi-threaded stress test (see stress()); their
+             last column is reads per second per reader.  load_mapped opens (and checksums) a file
+             written by save_binary and answers one lookup from it.
+             ingest_csv streams a file of n fare lines (16 routes) into
+             per-route frontiers with FareIngest; its last column is
+             records per second (build with -std=c++17 to parse with
+             std::from_chars).  route_planner (n = 1000 and 10000 cities,
+             see planner()) reports permanent labels per second.
+             join_view_top10 takes the 10 cheapest options of the join of
+             two frontiers from join_plus_plus_view (query snapshots built
+             in setup).  layered_erase erases one frontier option from a
+             LayeredTravelOptions holding the n raw options (the options
+             it hid move up from the next layer).  sort_in_place and
+             sort_and_prune_in_place sort the raw list by relinking its
+             nodes; sorted_clone copies it first.
+
+ NOTE:  is_sorted / is_pareto / is_pareto_sorted answer from cached
+        invariant flags when the list knows them (e.g., right after
+        from_vec every list knows whether it is sorted), so those rows
+        measure what callers actually pay, which can be O(1).
+*/
+
+typedef std::vector<std::pair<double, double>> OptionVec;
+
+struct Settings {
+  const char *json;
+  const char *stats;
+  const char *filter;
+  long max_n;
+  double pareto;
+  double dup;
+  double min_time;
+  unsigned seed;
+};
+
+/*
+ * Synthetic input of n options:
+ *   frontier:  the pareto frontier (sorted), about n * pareto options
+ *   raw:       frontier + dominated options + duplicates, shuffled
+ *   sorted:    raw, sorted
+ */
+struct Input {
+  OptionVec frontier;
+  OptionVec raw;
+  OptionVec sorted;
+};
+
+static Input make_input(long n, const Settings &cfg, std::mt19937 &gen) {
+  std::uniform_real_distribution<double> step(0.5, 10.0);
+  Input in;
+  long dups = (long)(n * cfg.dup);
+  long front = std::max(1L, std::min(n - dups, (long)(n * cfg.pareto)));
+  double price = 0, time = 20.0 * front;
+
+  for(long i=0; i<front; i++) {
+    price += step(gen);
+    time -= step(gen) / 10.0 + 0.01;
+    in.frontier.push_back(std::pair<double,double>(price, time));
+  }
+  in.raw = in.frontier;
+  while((long)in.raw.size() < n - dups) {
+    std::pair<double,double> o = in.frontier[gen() % front];
+    in.raw.push_back(std::pair<double,double>(o.first + step(gen), o.second + step(gen)));
+  }
+  while((long)in.raw.size() < n)
+    in.raw.push_back(in.raw[gen() % in.raw.size()]);
+  std::shuffle(in.raw.begin(), in.raw.end(), gen);
+  in.sorted = in.raw;
+  std::sort(in.sorted.begin(), in.sorted.end());
+  return in;
+}
+
+/*
+ * One benchmark:  setup builds whatever the operation needs (untimed), op is
+ *   the timed call; everything in State is deleted afterwards (untimed).
+ *   max_n caps the sizes for operations that are quadratic.
+ */
+struct State {
+  TravelOptions *a;
+  TravelOptions *b;
+  TravelOptions *result;
+  double price, time;
+};
+
+struct Benchmark {
+  const char *name;
+  long max_n;
+  std::function<void(State &, const Input &, const Input &, std::mt19937 &)> setup;
+  std::function<void(State &, const Input &)> op;
+};
+
+struct Result {
+  std::string name;
+  long n;
+  long iterations;
+  double mean_ns, p50_ns, p99_ns, min_ns;
+};
+
+// the original algorithm: the full cross product through insert_pareto_sorted
+static TravelOptions * brute_join(const TravelOptions &a, const TravelOptions &b) {
+  TravelOptions *tr = new TravelOptions();
+  OptionVec *va = a.to_vec(), *vb = b.to_vec();
+
+  for(size_t i=0; i<va->size(); i++)
+    for(size_t j=0; j<vb->size(); j++)
+      tr->insert_pareto_sorted((*va)[i].first + (*vb)[j].first,
+                               (*va)[i].second + (*vb)[j].second);
+  delete va;
+  delete vb;
+  return tr;
+}
+
+// scratch files for load_mapped and ingest_csv (removed at exit)
+static const char *MAPPED_FILE = "bench_frontier.bin";
+static const char *FEED_FILE = "bench_fares.csv";
+static LayeredTravelOptions layered;   // layered_erase
+
+// writes the raw options of in as a fare feed over 16 routes (once per input)
+static void write_feed(const Input &in) {
+  static size_t written = 0;
+  if(written == in.raw.size())
+    return;
+  FILE *f = fopen(FEED_FILE, "w");
+  if(f == nullptr)
+    return;
+  for(size_t i=0; i<in.raw.size(); i++)
+    fprintf(f, "C%zu,D%zu,%.17g,%.17g\n", i % 4, i / 4 % 4, in.raw[i].first, in.raw[i].second);
+  fclose(f);
+  written = in.raw.size();
+}
+
+static TravelOptions * load(const OptionVec &vec) {
+  OptionVec copy(vec);
+  return TravelOptions::from_vec(copy);
+}
+
+static void random_option(State &s, const Input &in, std::mt19937 &gen) {
+  const std::pair<double,double> &o = in.raw[gen() % in.raw.size()];
+  std::uniform_real_distribution<double> jitter(-1.0, 1.0);
+  s.price = o.first + jitter(gen);
+  s.time = o.second + jitter(gen);
+}
+
+static std::vector<Benchmark> benchmarks() {
+  std::vector<Benchmark> all;
+  Benchmark b;
+
+  b.name = "from_vec"; b.max_n = 1000000;
+  b.setup = [](State &, const Input &, const Input &, std::mt19937 &) {};
+  b.op = [](State &s, const Input &in) { s.result = load(in.raw); };
+  all.push_back(b);
+
+  b.name = "pareto_from_vec"; b.max_n = 1000000;
+  b.setup = [](State &, const Input &, const Input &, std::mt19937 &) {};
+  b.op = [](State &s, const Input &in) { s.result = TravelOptions::pareto_from_vec(in.raw); };
+  all.push_back(b);
+
+  b.name = "is_sorted"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &) { s.a = load(in.sorted); };
+  b.op = [](State &s, const Input &) { s.a->is_sorted(); };
+  all.push_back(b);
+
+  b.name = "is_pareto"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &) { s.a = load(in.raw); };
+  b.op = [](State &s, const Input &) { s.a->is_pareto(); };
+  all.push_back(b);
+
+  b.name = "insert_sorted"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &gen) {
+    s.a = load(in.sorted);
+    random_option(s, in, gen);
+  };
+  b.op = [](State &s, const Input &) { s.a->insert_sorted(s.price, s.time); };
+  all.push_back(b);
+
+  b.name = "insert_pareto_sorted"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &gen) {
+    s.a = load(in.frontier);
+    random_option(s, in, gen);
+  };
+  b.op = [](State &s, const Input &) { s.a->insert_pareto_sorted(s.price, s.time); };
+  all.push_back(b);
+
+  b.name = "union_pareto_sorted"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &in2, std::mt19937 &) {
+    s.a = load(in.frontier);
+    s.b = load(in2.frontier);
+  };
+  b.op = [](State &s, const Input &) { s.result = s.a->union_pareto_sorted(*s.b); };
+  all.push_back(b);
+
+  b.name = "prune_sorted"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &) { s.a = load(in.sorted); };
+  b.op = [](State &s, const Input &) { s.a->prune_sorted(); };
+  all.push_back(b);
+
+  b.name = "prune_epsilon"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &) { s.a = load(in.frontier); };
+  b.op = [](State &s, const Input &) { s.a->prune_epsilon(0.01, 0.01); };
+  all.push_back(b);
+
+  b.name = "join_plus_plus"; b.max_n = 10000;
+  b.setup = [](State &s, const Input &in, const Input &in2, std::mt19937 &) {
+    s.a = load(in.raw);
+    s.b = load(in2.raw);
+  };
+  b.op = [](State &s, const Input &) { s.result = s.a->join_plus_plus(*s.b); };
+  all.push_back(b);
+
+  b.name = "join_plus_plus_epsilon"; b.max_n = 100000;
+  b.setup = [](State &s, const Input &in, const Input &in2, std::mt19937 &) {
+    s.a = load(in.raw);
+    s.b = load(in2.raw);
+  };
+  b.op = [](State &s, const Input &) { s.result = s.a->join_plus_plus_epsilon(*s.b, 0.01, 0.01); };
+  all.push_back(b);
+
+  b.name = "join_plus_plus_parallel"; b.max_n = 100000;
+  b.setup = [](State &s, const Input &in, const Input &in2, std::mt19937 &) {
+    s.a = load(in.raw);
+    s.b = load(in2.raw);
+  };
+  b.op = [](State &s, const Input &) { s.result = s.a->join_plus_plus_parallel(*s.b); };
+  all.push_back(b);
+
+  b.name = "join_view_top10"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &in2, std::mt19937 &) {
+    s.a = load(in.frontier);
+    s.b = load(in2.frontier);
+    delete s.a->join_plus_plus_view(*s.b);   // builds both query snapshots
+  };
+  b.op = [](State &s, const Input &) {
+    TravelOptions::JoinView *v = s.a->join_plus_plus_view(*s.b);
+    for(int k = 0; k < 10 && v->next(s.price, s.time); k++)
+      ;
+    delete v;
+  };
+  all.push_back(b);
+
+  b.name = "join_plus_plus_brute"; b.max_n = 100;
+  b.setup = [](State &s, const Input &in, const Input &in2, std::mt19937 &) {
+    s.a = load(in.raw);
+    s.b = load(in2.raw);
+  };
+  b.op = [](State &s, const Input &) { s.result = brute_join(*s.a, *s.b); };
+  all.push_back(b);
+
+  b.name = "join_plus_max"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &in2, std::mt19937 &) {
+    s.a = load(in.frontier);
+    s.b = load(in2.frontier);
+  };
+  b.op = [](State &s, const Input &) { s.result = s.a->join_plus_max(*s.b); };
+  all.push_back(b);
+
+  b.name = "sorted_clone"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &) { s.a = load(in.raw); };
+  b.op = [](State &s, const Input &) { s.result = s.a->sorted_clone(); };
+  all.push_back(b);
+
+  b.name = "sort_in_place"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &) { s.a = load(in.raw); };
+  b.op = [](State &s, const Input &) { s.a->sort_in_place(); };
+  all.push_back(b);
+
+  b.name = "sort_and_prune_in_place"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &) { s.a = load(in.raw); };
+  b.op = [](State &s, const Input &) { s.a->sort_and_prune_in_place(); };
+  all.push_back(b);
+
+  b.name = "load_mapped"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &) {
+    s.a = load(in.frontier);
+    s.a->save_binary(MAPPED_FILE);
+  };
+  b.op = [](State &s, const Input &) {
+    FrontierFile *f = TravelOptions::load_mapped(MAPPED_FILE);
+    MappedOptions m;
+    if(f != nullptr && f->find("", m))
+      m.best_time_within_budget(s.a->size() * 5.0, s.price, s.time);
+    delete f;
+  };
+  all.push_back(b);
+
+  b.name = "ingest_csv"; b.max_n = 1000000;
+  b.setup = [](State &, const Input &in, const Input &, std::mt19937 &) { write_feed(in); };
+  b.op = [](State &, const Input &) {
+    FareIngest ingest;
+    ingest.ingest_file(FEED_FILE);
+  };
+  all.push_back(b);
+
+  b.name = "layered_erase"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &gen) {
+    layered.assign(in.raw);
+    const LayeredTravelOptions::Layer &f = layered.layer(0);
+    size_t k = gen() % f.size();
+    s.price = f[k].first;
+    s.time = f[k].second;
+  };
+  b.op = [](State &s, const Input &) { layered.erase(s.price, s.time); };
+  all.push_back(b);
+
+  b.name = "split_sorted_pareto"; b.max_n = 1000000;
+  b.setup = [](State &s, const Input &in, const Input &, std::mt19937 &) {
+    s.a = load(in.frontier);
+    s.price = in.frontier[in.frontier.size() / 2].first;
+  };
+  b.op = [](State &s, const Input &) { s.result = s.a->split_sorted_pareto(s.price); };
+  all.push_back(b);
+
+  return all;
+}
+
+static Result run(const Benchmark &bm, long n, const Input &in, const Input &in2,
+                  const Settings &cfg, std::mt19937 &gen) {
+  std::vector<double> samples;
+  double total_ns = 0;
+  std::chrono::steady_clock::time_point wall = std::chrono::steady_clock::now();
+
+  // at least one iteration; slow setups stop after 5x min_time of wall clock
+  while(samples.empty() ||
+        (total_ns < cfg.min_time * 1e9 && samples.size() < 100000 &&
+         std::chrono::steady_clock::now() - wall < std::chrono::duration<double>(5 * cfg.min_time))) {
+    State s = { nullptr, nullptr, nullptr, 0, 0 };
+    bm.setup(s, in, in2, gen);
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    bm.op(s, in);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+    samples.push_back(ns);
+    total_ns += ns;
+    delete s.a;
+    delete s.b;
+    delete s.result;
+  }
+
+  Result r;
+  r.name = std::string(bm.name) + "/" + std::to_string(n);
+  r.n = n;
+  r.iterations = samples.size();
+  r.mean_ns = total_ns / samples.size();
+  std::sort(samples.begin(), samples.end());
+  r.min_ns = samples.front();
+  r.p50_ns = samples[samples.size() / 2];
+  r.p99_ns = samples[std::min(samples.size() - 1, (size_t)(samples.size() * 0.99))];
+  return r;
+}
+
+/*
+ * Stress test (concurrent_read / mutex_read):  reader latency under write load.
+ *   One writer thread keeps calling insert_pareto_sorted on a frontier of about n
+ *   options while READERS threads each time one best_time_within_budget after
+ *   another, for 5x min_time.  concurrent_read shares the frontier through
+ *   ConcurrentTravelOptions (snapshots; readers never wait for the writer);
+ *   mutex_read is the coarse baseline, a TravelOptions behind one std::mutex.
+ */
+static const int READERS = 2;
+
+static Result stress(bool snapshots, long n, const Input &in, const Settings &cfg) {
+  ConcurrentTravelOptions shared;
+  TravelOptions locked;
+  std::mutex lock;
+  std::atomic<bool> stop(false);
+  std::vector<std::vector<double>> samples(READERS);
+  std::vector<std::thread> readers;
+  double top = in.frontier.back().first;
+
+  shared.update([&](TravelOptions &m) { TravelOptions::from_vec(in.frontier, m); });
+  TravelOptions::from_vec(in.frontier, locked);
+
+  for(int r=0; r<READERS; r++) {
+    readers.push_back(std::thread([&, r]() {
+      std::mt19937 gen(r);
+      std::uniform_real_distribution<double> budget(0, top);
+      double price, time;
+      while(!stop) {
+        double b = budget(gen);
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        if(snapshots) {
+          shared.best_time_within_budget(b, price, time);
+        }
+        else {
+          std::lock_guard<std::mutex> g(lock);
+          locked.best_time_within_budget(b, price, time);
+        }
+        samples[r].push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count());
+      }
+    }));
+  }
+
+  std::mt19937 gen(cfg.seed);
+  std::uniform_real_distribution<double> jitter(-1.0, 1.0);
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(5 * cfg.min_time));
+  while(std::chrono::steady_clock::now() < end) {
+    const std::pair<double,double> &o = in.frontier[gen() % in.frontier.size()];
+    double price = o.first + jitter(gen), time = o.second + jitter(gen);
+    if(snapshots) {
+      shared.insert_pareto_sorted(price, time);
+    }
+    else {
+      std::lock_guard<std::mutex> g(lock);
+      locked.insert_pareto_sorted(price, time);
+    }
+  }
+  stop = true;
+  for(int r=0; r<READERS; r++)
+    readers[r].join();
+
+  std::vector<double> all;
+  for(int r=0; r<READERS; r++)
+    all.insert(all.end(), samples[r].begin(), samples[r].end());
+  std::sort(all.begin(), all.end());
+  double total = 0;
+  for(size_t i=0; i<all.size(); i++)
+    total += all[i];
+
+  Result res;
+  res.name = std::string(snapshots ? "concurrent_read" : "mutex_read") + "/" + std::to_string(n);
+  res.n = n;
+  res.iterations = all.size();
+  res.mean_ns = all.empty() ? 0 : total / all.size();
+  res.min_ns = all.empty() ? 0 : all.front();
+  res.p50_ns = all.empty() ? 0 : all[all.size() / 2];
+  res.p99_ns = all.empty() ? 0 : all[std::min(all.size() - 1, (size_t)(all.size() * 0.99))];
+  return res;
+}
+
+/*
+ * Route planner (route_planner):  plan() from the corner city of a synthetic network of n
+ *   cities on a square grid.  Each city has a leg to each grid neighbour, of length 1-10, with
+ *   a bus fare <d, 3d> and on half the legs also a train fare <3d, d+1>; one city in 20 also
+ *   has a flight to a random city (expensive, fast).  The last column is permanent labels
+ *   (options of all frontiers) per second.
+ */
+static Result planner(long n, const Settings &cfg, double &labels_per_sec) {
+  std::mt19937 gen(cfg.seed);
+  long side = (long)std::ceil(std::sqrt((double)n));
+  RoutePlanner rp((int)n);
+
+  for(long c=0; c<n; c++) {
+    long x = c % side, y = c / side;
+    long next[4] = { x + 1 < side ? c + 1 : -1, x > 0 ? c - 1 : -1,
+                     c + side < n ? c + side : -1, c >= side ? c - side : -1 };
+    for(int k=0; k<4; k++) {
+      if(next[k] < 0)
+        continue;
+      double d = 1 + gen() % 10;
+      TravelOptions fares;
+      fares.push_front(d, 3 * d);
+      if(gen() % 2)
+        fares.push_front(3 * d, d + 1);
+      rp.add_leg((int)c, (int)next[k], fares);
+    }
+    if(gen() % 20 == 0) {
+      long to = gen() % n;
+      double d = std::abs(to % side - x) + std::abs(to / side - y);
+      rp.add_leg((int)c, (int)to, std::round(5 * d + 20), std::round(d / 4 + 5));
+    }
+  }
+
+  std::vector<double> samples;
+  double total = 0;
+  uint64_t settled = 0;
+  while(samples.empty() || (total < cfg.min_time * 1e9 && samples.size() < 1000)) {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    rp.plan(0);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    samples.push_back(ns);
+    total += ns;
+    settled = rp.stats().settled;
+  }
+  std::sort(samples.begin(), samples.end());
+
+  Result res;
+  res.name = "route_planner/" + std::to_string(n);
+  res.n = n;
+  res.iterations = samples.size();
+  res.mean_ns = total / samples.size();
+  res.min_ns = samples.front();
+  res.p50_ns = samples[samples.size() / 2];
+  res.p99_ns = samples[std::min(samples.size() - 1, (size_t)(samples.size() * 0.99))];
+  labels_per_sec = settled / (res.mean_ns * 1e-9);
+  return res;
+}
+
+static void write_json(const char *path, const std::vector<Result> &results, const Settings &cfg) {
+  FILE *f = fopen(path, "w");
+  if(f == nullptr) {
+    printf("ERR: cannot write %s\n", path);
+    return;
+  }
+  fprintf(f, "{\n  \"context\": {\n");
+  fprintf(f, "    \"executable\": \"TravelOptions bench\",\n");
+  fprintf(f, "    \"pareto_density\": %g,\n    \"duplicate_rate\": %g,\n", cfg.pareto, cfg.dup);
+  fprintf(f, "    \"seed\": %u,\n    \"min_time\": %g\n  },\n", cfg.seed, cfg.min_time);
+  fprintf(f, "  \"benchmarks\": [\n");
+  for(size_t i=0; i<results.size(); i++) {
+    const Result &r = results[i];
+    fprintf(f, "    {\n      \"name\": \"%s\",\n", r.name.c_str());
+    fprintf(f, "      \"n\": %ld,\n      \"iterations\": %ld,\n", r.n, r.iterations);
+    fprintf(f, "      \"real_time\": %.1f,\n      \"p50_time\": %.1f,\n", r.mean_ns, r.p50_ns);
+    fprintf(f, "      \"p99_time\": %.1f,\n      \"min_time\": %.1f,\n", r.p99_ns, r.min_ns);
+    fprintf(f, "      \"time_unit\": \"ns\",\n");
+    fprintf(f, "      \"items_per_second\": %.1f\n    }%s\n", r.n / (r.mean_ns * 1e-9),
+            i + 1 < results.size() ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+  fclose(f);
+}
+
+static const char * option(const char *arg, const char *name) {
+  size_t len = strlen(name);
+  return strncmp(arg, name, len) == 0 ? arg + len : nullptr;
+}
+
+int main(int argc, char *argv[]){
+  Settings cfg = { nullptr, nullptr, "", 1000000, 0.5, 0.1, 0.2, 42 };
+  std::vector<Result> results;
+
+  for(int i=1; i<argc; i++) {
+    const char *v;
+    if((v = option(argv[i], "--json=")) != nullptr) cfg.json = v;
+    else if((v = option(argv[i], "--stats=")) != nullptr) cfg.stats = v;
+    else if((v = option(argv[i], "--filter=")) != nullptr) cfg.filter = v;
+    else if((v = option(argv[i], "--max_n=")) != nullptr) cfg.max_n = atol(v);
+    else if((v = option(argv[i], "--pareto=")) != nullptr) cfg.pareto = atof(v);
+    else if((v = option(argv[i], "--dup=")) != nullptr) cfg.dup = atof(v);
+    else if((v = option(argv[i], "--min_time=")) != nullptr) cfg.min_time = atof(v);
+    else if((v = option(argv[i], "--seed=")) != nullptr) cfg.seed = atoi(v);
+    else {
+      printf("unknown option %s (see the comment at the top of bench.cpp)\n", argv[i]);
+      return 1;
+    }
+  }
+
+  std::mt19937 gen(cfg.seed);
+  std::vector<Benchmark> all = benchmarks();
+
+  printf("%-32s %10s %12s %12s %12s %14s\n", "benchmark", "iters", "mean(ns)", "p50(ns)", "p99(ns)", "options/s");
+  for(long n=10; n<=cfg.max_n; n*=10) {
+    Input in = make_input(n, cfg, gen);
+    Input in2 = make_input(n, cfg, gen);
+
+    for(size_t k=0; k<all.size(); k++) {
+      if(n > all[k].max_n || strstr(all[k].name, cfg.filter) == nullptr)
+        continue;
+      Result r = run(all[k], n, in, in2, cfg, gen);
+      printf("%-32s %10ld %12.0f %12.0f %12.0f %14.0f\n", r.name.c_str(), r.iterations,
+             r.mean_ns, r.p50_ns, r.p99_ns, r.n / (r.mean_ns * 1e-9));
+      fflush(stdout);
+      results.push_back(r);
+    }
+    for(int k=0; k<2 && n<=100000; k++) {
+      if(strstr(k ? "mutex_read" : "concurrent_read", cfg.filter) == nullptr)
+        continue;
+      Result r = stress(k == 0, n, in, cfg);
+      printf("%-32s %10ld %12.0f %12.0f %12.0f %14.0f\n", r.name.c_str(), r.iterations,
+             r.mean_ns, r.p50_ns, r.p99_ns, 1e9 / r.mean_ns);
+      fflush(stdout);
+      results.push_back(r);
+    }
+    if(n >= 1000 && n <= 10000 && strstr("route_planner", cfg.filter) != nullptr) {
+      double labels_per_sec;
+      Result r = planner(n, cfg, labels_per_sec);
+      printf("%-32s %10ld %12.0f %12.0f %12.0f %14.0f\n", r.name.c_str(), r.iterations,
+             r.mean_ns, r.p50_ns, r.p99_ns, labels_per_sec);
+      fflush(stdout);
+      results.push_back(r);
+    }
+  }
+  if(cfg.json != nullptr)
+    write_json(cfg.json, results, cfg);
+  if(cfg.stats != nullptr) {
+    FILE *f = fopen(cfg.stats, "w");
+    if(f != nullptr) {
+      fputs(trvl_stats::json().c_str(), f);
+      fclose(f);
+    }
+  }
+  remove(MAPPED_FILE);
+  remove(FEED_FILE);
+  return 0;
+}
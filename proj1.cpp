@@ -4,58 +4,476 @@
 #include <iostream>
 #include <vector>
 #include <utility>
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "Dominance.h"
+#include "FrontierFile.h"
+#include "TravelStats.h"
 
 
 // using namespace std;
 
-class TravelOptions{
+/*
+ * option_sum:  how the joins add prices (or times) of type T.  add() stores a + b in sum and returns
+ *   false if the sum does not fit in T (integer overflow).  Floating point sums never fail:  they
+ *   round, and a sum too large for the type becomes infinity, exactly as with plain +.
+ */
+template <typename T, bool = std::is_integral<T>::value>
+struct option_sum {
+  static bool add(T a, T b, T &sum) {
+    sum = a + b;
+    return true;
+  }
+};
+
+template <typename T>
+struct option_sum<T, true> {
+  static bool add(T a, T b, T &sum) {
+    return !__builtin_add_overflow(a, b, &sum);
+  }
+};
+
+/*
+ * PlusPlusMerge<Price, Time>:  the engine behind join_plus_plus, JoinView and FlatTravelOptions::join_plus_plus.
+ *   Given two sorted-pareto frontiers as (price, time) arrays, next() yields the sorted-pareto frontier of
+ *   all sums <pa+pb, ta+tb>, cheapest first.
+ *
+ *   Row i pairs option i of the shorter frontier with the whole longer one.  For a fixed row the sums are
+ *   themselves pareto-sorted, so the answer is the pareto merge of the rows, done in price order with a
+ *   heap holding one cursor per row started so far.  Rows start lazily:  row i+1 only joins the heap once
+ *   its first sum could be the cheapest one left.  A popped sum is kept iff it is faster than the last one
+ *   kept; a dominated cursor jumps (binary search) to the first sum of its row that beats the best time so
+ *   far, so runs of dominated pairings are skipped instead of enumerated.
+ *
+ *   The arrays are read in place:  they must outlive the merge and must not change while it is in use.
+ *   Sums are formed with plain +; the caller checks beforehand that they fit (see sums_fit).
+ *   RUNTIME:  O(log n + log m) per heap step; the number of steps tracks the output frontier, not n x m.
+ *     The first k options cost about O(k log k) heap work plus the jumps.
+ */
+template <typename Price, typename Time>
+class PlusPlusMerge {
+
+    //cursor j into the row rows[i]+cols[0..m-1]
+    struct Cursor {
+        Price price;
+        Time time;
+        size_t i, j;
+        bool operator>(const Cursor &c) const {
+            return price>c.price || (price==c.price && time>c.time);
+        }
+    };
+
+    const Price *_row_price, *_col_price;
+    const Time *_row_time, *_col_time;
+    size_t _n, _m;
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> _heap;
+    size_t _started;    // rows that have joined the heap
+    size_t _count;      // options returned so far
+    Time _best;         // time of the last option returned
+
+    void push(size_t i, size_t j) {
+        Cursor c={Price(_row_price[i]+_col_price[j]), Time(_row_time[i]+_col_time[j]), i, j};
+        _heap.push(c);
+    }
+
+  public:
+    PlusPlusMerge(const Price *a_price, const Time *a_time, size_t n,
+                  const Price *b_price, const Time *b_time, size_t m)
+        : _started(0), _count(0), _best() {
+        //the shorter frontier drives the heap (plus-plus is symmetric)
+        if (n <= m) {
+            _row_price = a_price; _row_time = a_time; _n = n;
+            _col_price = b_price; _col_time = b_time; _m = m;
+        }
+        else {
+            _row_price = b_price; _row_time = b_time; _n = m;
+            _col_price = a_price; _col_time = a_time; _m = n;
+        }
+        if (_m == 0)
+            _n = 0;
+    }
+
+   /**
+    * func: next
+    * desc: the next (pricier, faster) option of the joined frontier.  With capped, an option that would
+    *       cost more than cap is not returned (it stays next).
+    * returns: false once the frontier is exhausted or the next option is over the cap
+    */
+    bool next(Price &price, Time &time, bool capped=false, Price cap=Price()) {
+        for (;;) {
+            //unstarted rows are no cheaper than the next one's first sum; start it if it could be next
+            while (_started < _n &&
+                   (_heap.empty() || !(_heap.top().price < Price(_row_price[_started]+_col_price[0]))))
+                push(_started++, 0);
+            if (_heap.empty())
+                return false;
+
+            Cursor c = _heap.top();
+            if (capped && c.price > cap)
+                return false;
+            _heap.pop();
+
+            size_t nxt = c.j+1;
+            bool keep = _count == 0 || c.time < _best;
+            TRVL_STAT(COMPARES, 1);
+            if (!keep) {
+                //dominated; jump to the first sum of this row that beats the best time
+                TRVL_STAT(PRUNED, 1);
+                Time rt = _row_time[c.i];
+                size_t lo = nxt, hi = _m;
+                while (lo < hi) {
+                    size_t mid = lo+(hi-lo)/2;
+                    if (rt+_col_time[mid] < _best)
+                        hi = mid;
+                    else
+                        lo = mid+1;
+                }
+                nxt = lo;
+            }
+            if (nxt < _m)
+                push(c.i, nxt);
+            if (keep) {
+                price = c.price;
+                time = c.time;
+                _best = c.time;
+                _count++;
+                return true;
+            }
+        }
+    }
+
+    // options returned so far
+    size_t count() const {
+        return _count;
+    }
+};
+
+/*
+ * BasicTravelOptions<Price, Time>:  a list of <price,time> options with prices of type Price and
+ *   times of type Time.  Comparisons, sorting and the joins are all instantiated for the two types.
+ *
+ *   TravelOptions    (double, double)    the original class; every comment below is written for it
+ *   TravelOptions32  (int32_t, int32_t)  e.g. cents and minutes:  16-byte nodes instead of 24
+ *   TravelOptionsF   (float, float)      16-byte nodes
+ *
+ * With integer types, join_plus_plus / join_plus_max fail (nullptr or false) rather than wrap
+ *   around when a total price or time does not fit the type (see option_sum).
+ */
+template <typename Price = double, typename Time = double>
+class BasicTravelOptions{
 
   public:
 	enum Relationship { better, worse, equal, incomparable};
 
   private:
 	  struct Node {
-		  double price;
-		  double time;
+		  Price price;
+		  Time time;
 		  Node *next;
 
-		  Node(double _price=0, double _time=0, Node* _next=nullptr){
+		  Node(Price _price=Price(), Time _time=Time(), Node* _next=nullptr){
 			  price = _price; time = _time; next = _next;
 		  }
 
 	  };
 
+	  /*
+	   * NodePool:  where every Node comes from (and goes back to).
+	   *
+	   * Nodes are carved out of large chunks and recycled through free chains instead of
+	   *   one new/delete per option.  Each thread has its own pool, so no locking on the
+	   *   hot path; a node may be freed by a different thread than the one that created it.
+	   *
+	   * Free nodes are kept as a stack of chains linked through next.  A single freed node
+	   *   is pushed onto the top chain; a whole list (clear()) becomes a new chain in O(1).
+	   *
+	   * Chunks are never returned to the system (they are registered with a process-wide
+	   *   depot); a thread's free chains are handed to the depot when the thread exits and
+	   *   adopted by the next pool that is created.
+	   *
+	   * A pool is destroyed with its thread (for the main thread, during exit teardown, in no
+	   *   fixed order with statics).  A TravelOptions that outlives it, e.g. a file-scope list,
+	   *   still works:  once gone() is set, nodes come from and go to the depot under its lock.
+	   *
+	   * Define TRVL_NO_POOL to fall back to plain new/delete (e.g., for memory checkers).
+	   */
+	  struct NodePool {
+		  std::vector<Node *> chains;  // free chains; the last one feeds alloc
+		  Node *bump;                  // next unused node of the newest chunk
+		  size_t left;                 // unused nodes left in the newest chunk
+		  size_t chunk;                // size of the next chunk to allocate
+
+		  struct Depot {
+			  std::mutex lock;
+			  std::vector<Node *> chunks;
+			  std::vector<Node *> chains;
+		  };
+
+		  // never destroyed, so chunks stay reachable until the process exits
+		  static Depot &depot() {
+			  static Depot *d = new Depot();
+			  return *d;
+		  }
+
+		  NodePool() {
+			  bump = nullptr; left = 0; chunk = 64;
+			  Depot &d = depot();
+			  std::lock_guard<std::mutex> g(d.lock);
+			  chains.swap(d.chains);
+		  }
+
+		  // set when the calling thread's pool has been destroyed; a trivially destructible
+		  // thread_local, so it can still be read after that
+		  static bool &gone() {
+			  static thread_local bool g = false;
+			  return g;
+		  }
+
+		  ~NodePool() {
+			  gone() = true;
+			  // the unused end of the newest chunk becomes one more free chain
+			  if(left > 0) {
+				  for(size_t i=0; i+1<left; i++)
+					  bump[i].next = &bump[i+1];
+				  bump[left-1].next = nullptr;
+				  chains.push_back(bump);
+			  }
+			  Depot &d = depot();
+			  std::lock_guard<std::mutex> g(d.lock);
+			  d.chains.insert(d.chains.end(), chains.begin(), chains.end());
+		  }
+
+		  Node * alloc(Price price, Time time, Node *next) {
+			  Node *n;
+			  if(!chains.empty()) {
+				  n = chains.back();
+				  if(n->next != nullptr)
+					  chains.back() = n->next;
+				  else
+					  chains.pop_back();
+			  }
+			  else {
+				  if(left == 0) {
+					  bump = new Node[chunk];
+					  left = chunk;
+					  if(chunk < 4096) chunk *= 2;
+					  Depot &d = depot();
+					  std::lock_guard<std::mutex> g(d.lock);
+					  d.chunks.push_back(bump);
+				  }
+				  n = bump++;
+				  left--;
+			  }
+			  n->price = price; n->time = time; n->next = next;
+			  return n;
+		  }
+
+		  void free(Node *n) {
+			  if(chains.empty()) {
+				  n->next = nullptr;
+				  chains.push_back(n);
+			  }
+			  else {
+				  n->next = chains.back();
+				  chains.back() = n;
+			  }
+		  }
+
+		  void free_chain(Node *head) {
+			  if(head != nullptr)
+				  chains.push_back(head);
+		  }
+
+		  // after gone():  straight from / to the depot
+		  static Node * depot_alloc(Price price, Time time, Node *next) {
+			  Depot &d = depot();
+			  std::lock_guard<std::mutex> g(d.lock);
+			  Node *n;
+			  if(!d.chains.empty()) {
+				  n = d.chains.back();
+				  if(n->next != nullptr)
+					  d.chains.back() = n->next;
+				  else
+					  d.chains.pop_back();
+			  }
+			  else {
+				  n = new Node[1];
+				  d.chunks.push_back(n);
+			  }
+			  n->price = price; n->time = time; n->next = next;
+			  return n;
+		  }
+
+		  static void depot_free_chain(Node *head) {
+			  if(head == nullptr)
+				  return;
+			  Depot &d = depot();
+			  std::lock_guard<std::mutex> g(d.lock);
+			  d.chains.push_back(head);
+		  }
+	  };
+
+	  static NodePool &pool() {
+		  static thread_local NodePool p;
+		  return p;
+	  }
+
+	  static Node * new_node(Price price, Time time, Node *next=nullptr) {
+		  TRVL_STAT(NODES_ALLOCATED, 1);
+#ifdef TRVL_NO_POOL
+		  return new Node(price, time, next);
+#else
+		  if(NodePool::gone())
+			  return NodePool::depot_alloc(price, time, next);
+		  return pool().alloc(price, time, next);
+#endif
+	  }
+
+	  static void free_node(Node *n) {
+		  TRVL_STAT(NODES_FREED, 1);
+#ifdef TRVL_NO_POOL
+		  delete n;
+#else
+		  if(NodePool::gone()) {
+			  n->next = nullptr;
+			  NodePool::depot_free_chain(n);
+			  return;
+		  }
+		  pool().free(n);
+#endif
+	  }
+
+	  static void free_chain(Node *head) {
+#ifdef TRVL_NO_POOL
+		  while(head != nullptr) {
+			  Node *nxt = head->next;
+			  delete head;
+			  head = nxt;
+		  }
+#else
+		  if(NodePool::gone())
+			  NodePool::depot_free_chain(head);
+		  else
+			  pool().free_chain(head);
+#endif
+	  }
+
     /* TravelOptions private data members */
     Node *front;  // pointer for first node in linked list (or null if list is empty)
     int _size;
+    mutable unsigned char _known;  // invariant flags known for the current list (see invariant())
+    mutable unsigned char _holds;  // ... and whether they hold
+
+    /* contiguous snapshot of the list for the price-bounded queries and is_pareto */
+    struct PriceIndex {
+        std::vector<Price> price;
+        std::vector<Time> time;
+        bool valid;  // false once the list has been mutated since the snapshot was taken
+    };
+    mutable PriceIndex *_index;  // created by the first query (or null)
+
+    // the list changed:  the next query rebuilds the snapshot (its buffers are reused)
+    void drop_index() {
+        if(_index != nullptr)
+            _index->valid = false;
+    }
 
   public:
     // constructors
-    TravelOptions() {
+    BasicTravelOptions() {
+      front = nullptr;
+      _size=0;
+      _known = _holds = ALL_INVARIANTS;
+      _index = nullptr;
+    }
+
+    // deep copy:  the new object has its own nodes (the invariant flags come along)
+    BasicTravelOptions(const BasicTravelOptions &other) {
+      front = nullptr;
+      _size=0;
+      _known = _holds = ALL_INVARIANTS;
+      _index = nullptr;
+      *this = other;
+    }
+
+    // move:  steals other's node chain in O(1); other is left empty
+    BasicTravelOptions(BasicTravelOptions &&other) {
       front = nullptr;
       _size=0;
+      _known = _holds = ALL_INVARIANTS;
+      _index = nullptr;
+      swap_list(other);
     }
 
-    ~TravelOptions( ) {
+    ~BasicTravelOptions( ) {
       clear();
+      delete _index;
+    }
+
+   /**
+   * func: operator= (copy)
+   * desc: makes the calling object a deep copy of other.  The calling object's existing nodes are
+   *       overwritten in place (extra ones are freed, missing ones are allocated).
+   * RUNTIME:  O(n)
+   * status:  DONE
+   */
+    BasicTravelOptions & operator=(const BasicTravelOptions &other) {
+      if(this != &other) {
+        Rewriter w(*this);
+        for(Node *p = other.front; p != nullptr; p = p->next)
+          w.append(p->price, p->time);
+        w.finish(other._known, other._holds);
+      }
+      return *this;
+    }
+
+   /**
+   * func: operator= (move)
+   * desc: the calling object's options are deleted and replaced by other's node chain in O(1);
+   *       other is left empty.
+   * status:  DONE
+   */
+    BasicTravelOptions & operator=(BasicTravelOptions &&other) {
+      if(this != &other) {
+        clear();
+        swap_list(other);
+      }
+      return *this;
+    }
+
+   /**
+   * func: swap
+   * desc: exchanges the options of the two objects in O(1)
+   * status:  DONE
+   */
+    void swap(BasicTravelOptions &other) {
+      swap_list(other);
     }
 
 
    /**
    * func: clear
-   * desc: Deletes all Nodes currently in the list
+   * desc: Deletes all Nodes currently in the list (the whole chain goes back to the
+   *       node pool in O(1))
    * status:  DONE
    */
     void clear(){
-    Node *p, *pnxt;
-       p = front;
-       while(p != nullptr) {
-         pnxt = p->next;
-         delete p;
-         p = pnxt;
-       }
+       TRVL_STAT(NODES_FREED, _size);
+       free_chain(front);
        _size = 0;
        front = nullptr;
+       _known = _holds = ALL_INVARIANTS;
+       drop_index();
     }
 
 
@@ -104,27 +522,51 @@ class TravelOptions{
                     std::cout << "looks like option b is useless!" << std::endl;
                 // etcetera
     * 
-    * status: TODO 
+    * status: DONE 
     */          
-    static Relationship compare(double priceA, double timeA, 
- 					double priceB, double timeB) {
+    static Relationship compare(Price priceA, Time timeA, 
+ 					Price priceB, Time timeB) {
+ 					    TRVL_STAT(COMPARES, 1);
  					    if(priceA == priceB && timeA == timeB)
  					    {
  					        return equal;
  					    }
- 					    else if(priceA <= priceB && timeA < timeB)
+ 					    else if(priceA <= priceB && timeA <= timeB)
  					    {
  					        return better;
  					    }
- 					    else if(priceA >= priceB && timeA > timeB)
+ 					    else if(priceA >= priceB && timeA >= timeB)
  					    {
  					        return worse;
  					    }
  					    else
  					    {
+ 					        return incomparable;
+ 					    }
+    }
 
-      return incomparable;  // placeholder
-
+    /**
+    * func: compare_many
+    * desc: compares option A (priceA, timeA) with n options B[j] (pricesB[j], timesB[j]) at once:
+    *       out[j] = compare(priceA, timeA, pricesB[j], timesB[j]), with exactly the same results as
+    *       the scalar compare (including equal and incomparable).
+    *
+    *       Runs the vectorized kernels from Dominance.h (AVX2 or SSE2, picked at run time, with a
+    *       portable scalar fallback), 4-8 options per step.
+    *
+    * status: DONE
+    */
+    static void compare_many(Price priceA, Time timeA, const Price *pricesB,
+                             const Time *timesB, int n, Relationship *out) {
+        unsigned char codes[64];
+
+        TRVL_STAT(COMPARES, n);
+        for(int j = 0; j < n; j += 64) {
+            int len = std::min(64, n - j);
+            dominance::compare_block(priceA, timeA, pricesB + j, timesB + j, len, codes);
+            for(int k = 0; k < len; k++)
+                out[j + k] = (Relationship)codes[k];
+        }
     }
 
   private:
@@ -146,7 +588,251 @@ class TravelOptions{
        }
        return compare(a->price, a->time, b->price, b->time);
     }
-    
+
+    /**
+     * func: pareto_sweep
+     * desc: private utility which turns an arbitrary vector of <price,time> pairs into its
+     *       sorted-pareto frontier in place:  sort by price (time breaks ties), then keep
+     *       each option that is strictly faster than the last one kept.
+     *
+     * RUNTIME: O(n log n)
+     * status: DONE
+     */
+    static void pareto_sweep(std::vector<std::pair<Price, Time>> &buf) {
+       size_t kept = 0;
+
+       std::sort(buf.begin(), buf.end());
+       for(size_t i=0; i<buf.size(); i++) {
+           if(kept == 0 || buf[i].second < buf[kept-1].second)
+               buf[kept++] = buf[i];
+       }
+       TRVL_STAT(COMPARES, buf.size());
+       TRVL_STAT(PRUNED, buf.size() - kept);
+       buf.resize(kept);
+    }
+
+    /**
+     * func: pareto_frontier
+     * desc: private utility; the sorted-pareto frontier of the calling object's options
+     *       as a contiguous vector (the list itself is unaltered).  A list that is already
+     *       pareto-sorted is copied as is.
+     *
+     * RUNTIME: O(n) if already pareto-sorted; O(n log n) otherwise
+     * status: DONE
+     */
+    std::vector<std::pair<Price, Time>> pareto_frontier() const {
+       std::vector<std::pair<Price, Time>> buf;
+       Node *p = front;
+
+       buf.reserve(_size);
+       while(p != nullptr) {
+           buf.push_back(std::pair<Price, Time>(p->price, p->time));
+           p = p->next;
+       }
+       TRVL_STAT(NODES_VISITED, _size);
+       if(!is_pareto_sorted())
+           pareto_sweep(buf);
+       return buf;
+    }
+
+    /**
+     * func: merge_plus_plus
+     * desc: private engine behind join_plus_plus.  a and b are sorted-pareto frontiers;
+     *       out is overwritten with the sorted-pareto frontier of all <pa+pb, ta+tb>
+     *       (drains a PlusPlusMerge over the two frontiers, split into price and time arrays).
+     *
+     * RUNTIME: O(n + m) to split the frontiers, then see PlusPlusMerge
+     * status: DONE
+     */
+    static void merge_plus_plus(const std::vector<std::pair<Price, Time>> &a,
+                                const std::vector<std::pair<Price, Time>> &b,
+                                std::vector<std::pair<Price, Time>> &out) {
+       std::vector<Price> ap(a.size()), bp(b.size());
+       std::vector<Time> at(a.size()), bt(b.size());
+       Price p;
+       Time t;
+
+       for (size_t i=0; i<a.size(); i++){
+           ap[i]=a[i].first;
+           at[i]=a[i].second;
+       }
+       for (size_t i=0; i<b.size(); i++){
+           bp[i]=b[i].first;
+           bt[i]=b[i].second;
+       }
+       PlusPlusMerge<Price, Time> merge(ap.data(), at.data(), a.size(), bp.data(), bt.data(), b.size());
+       out.clear();
+       while (merge.next(p, t))
+           out.push_back(std::pair<Price, Time>(p, t));
+    }
+
+    /**
+     * func: union_frontiers
+     * desc: private utility; out is overwritten with the sorted-pareto union of the
+     *       sorted-pareto frontiers a and b (two-pointer merge; an option is kept iff it is
+     *       strictly faster than the last one kept).
+     *
+     * RUNTIME: O(|a| + |b|)
+     * status: DONE
+     */
+    static void union_frontiers(const std::vector<std::pair<Price, Time>> &a,
+                                const std::vector<std::pair<Price, Time>> &b,
+                                std::vector<std::pair<Price, Time>> &out) {
+       size_t i=0, j=0;
+
+       out.clear();
+       out.reserve(a.size()+b.size());
+       while (i<a.size() || j<b.size()){
+           const std::pair<Price, Time> &x =
+               (j==b.size() || (i<a.size() && a[i]<=b[j])) ? a[i++] : b[j++];
+           if (out.empty() || x.second<out.back().second)
+               out.push_back(x);
+       }
+       TRVL_STAT(COMPARES, a.size()+b.size());
+       TRVL_STAT(PRUNED, a.size()+b.size()-out.size());
+    }
+
+    /**
+     * func: sums_fit
+     * desc: private utility; true iff every sum <pa+pb, ta+tb> over the sorted-pareto frontiers a
+     *       and b fits in Price / Time (see option_sum).  Prices rise and times fall along a
+     *       frontier, so the smallest and largest sums are first+first and last+last; checking
+     *       those covers all n x m pairings.
+     * status: DONE
+     */
+    static bool sums_fit(const std::vector<std::pair<Price, Time>> &a,
+                         const std::vector<std::pair<Price, Time>> &b) {
+       Price p;
+       Time t;
+
+       if (a.empty() || b.empty())
+           return true;
+       return option_sum<Price>::add(a.front().first, b.front().first, p) &&
+              option_sum<Price>::add(a.back().first, b.back().first, p) &&
+              option_sum<Time>::add(a.front().second, b.front().second, t) &&
+              option_sum<Time>::add(a.back().second, b.back().second, t);
+    }
+
+    /**
+     * func: epsilon_sweep
+     * desc: private engine behind prune_epsilon.  buf is a sorted-pareto frontier with no negative
+     *       values; it is reduced to an epsilon-pareto subset:  every dropped option <p,t> has a kept
+     *       option <p',t'> with p' <= (1+eps_price) p and t' <= (1+eps_time) t.
+     *
+     *       Greedy, front to back:  for the cheapest option i not yet covered, keep the last option j
+     *       with price within (1+eps_price) of i's (it covers i .. j, being cheap enough and faster),
+     *       then skip every later option whose time is within (1+eps_time) of j's.  The next option
+     *       left uncovered is more than (1+eps_price) pricier and (1+eps_time) faster than the last
+     *       starting point, so the kept options number at most
+     *           1 + min(log(p_max/p_min) / log(1+eps_price), log(t_max/t_min) / log(1+eps_time))
+     *       (for positive prices / times).
+     *
+     *       err_price / err_time are set to the largest relative error actually introduced
+     *       (p'/p - 1 and t'/t - 1 over the dropped options; 0 if nothing was dropped).
+     * RUNTIME: O(n)
+     * status: DONE
+     */
+    static void epsilon_sweep(std::vector<std::pair<Price, Time>> &buf, double eps_price, double eps_time,
+                              double &err_price, double &err_time) {
+       size_t kept=0, i=0, n=buf.size();
+
+       err_price = err_time = 0;
+       while (i<n){
+           double cap = (1+eps_price) * (double)buf[i].first;
+           size_t j = i;
+           while (j+1<n && (double)buf[j+1].first <= cap)
+               j++;
+           //i .. j-1 are covered by j:  as fast or faster, price within (1+eps_price)
+           if (j>i && buf[i].first > 0)
+               err_price = std::max(err_price, (double)buf[j].first / (double)buf[i].first - 1);
+           buf[kept++] = buf[j];
+
+           //later options are covered by j while j's time is within (1+eps_time) of theirs
+           size_t x = j+1;
+           while (x<n && (double)buf[j].second <= (1+eps_time) * (double)buf[x].second)
+               x++;
+           if (x>j+1 && buf[x-1].second > 0)
+               err_time = std::max(err_time, (double)buf[j].second / (double)buf[x-1].second - 1);
+           i = x;
+       }
+       TRVL_STAT(COMPARES, n);
+       TRVL_STAT(PRUNED, n-kept);
+       buf.resize(kept);
+    }
+
+    /**
+     * func: Workers
+     * desc: private utility; a team of nthreads threads (the calling thread is one of them) that runs
+     *       several rounds of tasks.  run(count, task) calls task(0) .. task(count-1) on the team and
+     *       returns when all are done; threads pull the next task index from a shared counter, so uneven
+     *       tasks balance out.  The helper threads are started once, by the constructor, and wait between
+     *       rounds, so a multi-round job (join_plus_plus_parallel) pays for thread creation only once.
+     * status: DONE
+     */
+    class Workers {
+        std::vector<std::thread> _threads;
+        std::mutex _lock;
+        std::condition_variable _start, _done;
+        const std::function<void(size_t)> *_task;
+        size_t _count;
+        std::atomic<size_t> _next;
+        unsigned _round, _busy;
+        bool _stop;
+
+        void drain() {
+            for (size_t k=_next++; k<_count; k=_next++)
+                (*_task)(k);
+        }
+
+        void loop() {
+            unsigned seen = 0;
+            std::unique_lock<std::mutex> g(_lock);
+            for (;;) {
+                _start.wait(g, [&]() { return _stop || _round != seen; });
+                if (_stop)
+                    return;
+                seen = _round;
+                g.unlock();
+                drain();
+                g.lock();
+                if (--_busy == 0)
+                    _done.notify_one();
+            }
+        }
+
+      public:
+        explicit Workers(unsigned nthreads) : _task(nullptr), _count(0), _next(0), _round(0), _busy(0), _stop(false) {
+            for (unsigned t=1; t<nthreads; t++)
+                _threads.push_back(std::thread(&Workers::loop, this));
+        }
+
+        ~Workers() {
+            {
+                std::lock_guard<std::mutex> g(_lock);
+                _stop = true;
+            }
+            _start.notify_all();
+            for (size_t t=0; t<_threads.size(); t++)
+                _threads[t].join();
+        }
+
+        // every helper takes part in every round (one with nothing left to do just checks in)
+        void run(size_t count, const std::function<void(size_t)> &task) {
+            {
+                std::lock_guard<std::mutex> g(_lock);
+                _task = &task;
+                _count = count;
+                _next = 0;
+                _busy = (unsigned)_threads.size();
+                _round++;
+            }
+            _start.notify_all();
+            drain();
+            std::unique_lock<std::mutex> g(_lock);
+            _done.wait(g, [&]() { return _busy == 0; });
+        }
+    };
+
   public:
     
     
@@ -158,9 +844,26 @@ class TravelOptions{
    * desc: Adds a <price,time> option to the front of the list (simple primitive for building lists)
    * status:  DONE
    */
-    void push_front(double price, double time) {
-      front = new Node(price, time, front);
+    void push_front(Price price, Time time) {
+      Node *old = front;
+      front = new_node(price, time, front);
       _size++;
+      drop_index();
+
+      //only the new first pair can break the (adjacent-pair) sorted properties
+      if(old != nullptr) {
+        unsigned char known = _known, holds = _holds;
+        bool in_order = price < old->price || (price == old->price && time <= old->time);
+        bool strict = price < old->price && time > old->time;
+
+        _known = 0;
+        if(known & SORTED)
+          note(SORTED, (holds & SORTED) && in_order);
+        if(known & PARETO_SORTED)
+          note(PARETO_SORTED, (holds & PARETO_SORTED) && strict);
+        if((known & PARETO) && !(holds & PARETO) && !(_known & PARETO))
+          note(PARETO, false);
+      }
     }
 
    /**
@@ -172,8 +875,9 @@ class TravelOptions{
    * returns: a pointer to the resulting TravelOptions object
    * status:  DONE
    */
-    static TravelOptions * from_vec(std::vector<std::pair<double, double> > &vec) {
-	TravelOptions *options = new TravelOptions();
+    static BasicTravelOptions * from_vec(std::vector<std::pair<Price, Time> > &vec) {
+	TRVL_STAT_OP(FROM_VEC);
+	BasicTravelOptions *options = new BasicTravelOptions();
 
 	for(int i=vec.size()-1; i>=0; i--) {
 		options->push_front(vec[i].first, vec[i].second);
@@ -181,6 +885,58 @@ class TravelOptions{
 	return options;
     }
 
+   /**
+   * func: from_vec (into out)
+   * desc: same as from_vec above, but the options replace the contents of out (whose nodes are reused)
+   * status:  DONE
+   */
+    static void from_vec(const std::vector<std::pair<Price, Time> > &vec, BasicTravelOptions &out) {
+	TRVL_STAT_OP(FROM_VEC);
+	Rewriter w(out);
+
+	for(size_t i=0; i<vec.size(); i++)
+		w.append(vec[i].first, vec[i].second);
+	w.finish(0, 0);
+    }
+
+   /**
+   * func: pareto_from_range
+   * desc: builds the sorted-pareto option list of the <price,time> pairs in [first, last)
+   *       (which may be unsorted and contain duplicates and dominated options).
+   *
+   *       The pairs are copied into one scratch buffer, sorted by price (time breaks ties)
+   *       and swept once keeping each option that is strictly faster than the last option
+   *       kept.  The survivors are then linked back-to-front, so exactly one node is
+   *       created per frontier option (no insert_sorted, no temporary list).
+   *
+   * returns: a pointer to the resulting (sorted and pareto) TravelOptions object
+   * RUNTIME: O(n log n)
+   * status:  DONE
+   */
+    template <typename Iter>
+    static BasicTravelOptions * pareto_from_range(Iter first, Iter last) {
+	TRVL_STAT_OP(PARETO_FROM_VEC);
+	std::vector<std::pair<Price, Time>> buf(first, last);
+	BasicTravelOptions *options = new BasicTravelOptions();
+
+	pareto_sweep(buf);
+	for(size_t i=buf.size(); i>0; i--) {
+		options->push_front(buf[i-1].first, buf[i-1].second);
+	}
+	return options;
+    }
+
+   /**
+   * func: pareto_from_vec
+   * desc: same as pareto_from_range over the whole vector (the vector is not modified).
+   * returns: a pointer to the resulting (sorted and pareto) TravelOptions object
+   * RUNTIME: O(n log n)
+   * status:  DONE
+   */
+    static BasicTravelOptions * pareto_from_vec(const std::vector<std::pair<Price, Time> > &vec) {
+	return pareto_from_range(vec.begin(), vec.end());
+    }
+
    /**
    * func: to_vec
    * desc: Utility function which creates a C++ standard libary vector of pair<double,double>.
@@ -191,17 +947,105 @@ class TravelOptions{
    * returns: a pointer to the resulting vector
    * status:  DONE
    */
-    std::vector<std::pair<double, double>> * to_vec() const {
-      std::vector<std::pair<double, double>> *vec = new std::vector<std::pair<double, double>>();
+    std::vector<std::pair<Price, Time>> * to_vec() const {
+      std::vector<std::pair<Price, Time>> *vec = new std::vector<std::pair<Price, Time>>();
       Node *p = front;
 
       while(p != nullptr) {
-           vec->push_back(std::pair<double,double>(p->price, p->time));
+           vec->push_back(std::pair<Price, Time>(p->price, p->time));
            p = p->next;
       }
       return vec;
     }
 
+   /**
+   * func: to_vec (into out)
+   * desc: same as to_vec above, but the options replace the contents of out (its capacity is reused)
+   * status:  DONE
+   */
+    void to_vec(std::vector<std::pair<Price, Time>> &out) const {
+      out.clear();
+      out.reserve(_size);
+      for(Node *p = front; p != nullptr; p = p->next)
+           out.push_back(std::pair<Price, Time>(p->price, p->time));
+      TRVL_STAT(NODES_VISITED, _size);
+    }
+
+   /**
+   * func: save_binary
+   * desc: writes the options (in list order) to path as a FrontierFile (see FrontierFile.h) holding one
+   *       frontier under the empty route key, together with the list's sorted / pareto flags.  The
+   *       second form writes many lists, one per route key, into one file.  Records are always stored as
+   *       doubles (exact for int32_t and float options).
+   * returns: true on success; false if the file cannot be written, or (second form) a list is null or a
+   *       key is repeated.
+   * status:  DONE
+   */
+    bool save_binary(const char *path) const {
+      std::vector<std::pair<std::string, const BasicTravelOptions *>> one(1, std::make_pair(std::string(), this));
+      return save_binary(path, one);
+    }
+
+    static bool save_binary(const char *path,
+                            const std::vector<std::pair<std::string, const BasicTravelOptions *>> &routes) {
+      std::vector<FrontierFile::Entry> entries(routes.size());
+
+      for(size_t i=0; i<routes.size(); i++) {
+        const BasicTravelOptions *l = routes[i].second;
+        if(l == nullptr)
+          return false;
+        entries[i].key = routes[i].first;
+        entries[i].options.reserve(l->_size);
+        for(Node *p = l->front; p != nullptr; p = p->next)
+          entries[i].options.push_back(std::pair<double,double>((double)p->price, (double)p->time));
+        entries[i].flags = (l->is_sorted() ? SORTED : 0) | (l->is_pareto() ? PARETO : 0) |
+                           (l->is_pareto_sorted() ? PARETO_SORTED : 0);
+      }
+      return FrontierFile::write(path, entries);
+    }
+
+   /**
+   * func: load_mapped
+   * desc: opens a file written by save_binary without reading it into lists:  the file is memory-mapped and
+   *       each frontier is a MappedOptions view (size, to_vec, is_pareto_sorted, split_sorted_pareto and the
+   *       price / time lookups answer straight from the mapped records).  Use find("") for a file written
+   *       by the one-list save_binary, find(key) for a route.  verify checks the checksum (one pass over
+   *       the file).
+   * returns: pointer to the open file (delete it when done; views die with it), or nullptr if path is
+   *       missing, of another version or corrupt.
+   * status:  DONE
+   */
+    static FrontierFile * load_mapped(const char *path, bool verify=true) {
+      return FrontierFile::open(path, verify);
+    }
+
+   /**
+   * func: from_mapped
+   * desc: builds a TravelOptions object from a mapped frontier (same order).  The saved doubles are
+   *       converted to Price / Time.  For double / double the saved flags come along, so the new list
+   *       already knows whether it is sorted / pareto; for other types the conversion can round two
+   *       options to equal or out-of-order values, so the flags start unknown (the first query scans).
+   * returns: pointer to the new object
+   * RUNTIME:  O(n)
+   * status:  DONE
+   */
+    static BasicTravelOptions * from_mapped(const MappedOptions &m) {
+      BasicTravelOptions *tr = new BasicTravelOptions();
+
+      for(int i=m.size()-1; i>=0; i--)
+        tr->front = new_node((Price)m.price(i), (Time)m.time(i), tr->front);
+      tr->_size = m.size();
+      if(std::is_same<Price, double>::value && std::is_same<Time, double>::value) {
+        tr->_holds = (m.is_sorted() ? SORTED : 0) | (m.is_pareto() ? PARETO : 0) |
+                     (m.is_pareto_sorted() ? PARETO_SORTED : 0);
+        tr->_known = ALL_INVARIANTS;
+      }
+      else {
+        tr->_known = tr->_holds = 0;
+      }
+      return tr;
+    }
+
 
     /**
     * func: is_sorted
@@ -234,40 +1078,15 @@ class TravelOptions{
     *   The option list below is also NOT sorted by our rules:
     *      [ <1, 7>, <2, 8>, <2, 5>, <3, 7>]
     *                        ^^^^^^ must be before <2,8>
-    * status: TODO
+    * status: DONE
+    *
+    * CACHED:  the answer is kept in the invariant flags (see invariant() below), so only the first
+    *          call after a mutation that could not update the flag itself pays for the O(n) scan.
     */
     bool is_sorted()const{
-        Node *a = front->price;//setting the price in pair format list to a 
-        Node *b = front->time;//setting the time in pair format list to b
-        
-        while(a != nullptr && b != nullptr)
-        {
-            if(a < a->next)
-            {
-                return true;
-            }
-            else if(a == a->next)
-            {
-                if(b > b->next)
-                {
-                    return true;
-                }
-                else if(b == b->next)
-                {
-                    return true;
-                }
-            }
-            else
-            {
-                return false;
-            }
-        }
-        
-	return false;
-
+        return invariant(SORTED);
     }
 
-
     /**
     * func: is_pareto
     * desc: returns true if and only if:
@@ -277,7 +1096,7 @@ class TravelOptions{
     *           any other option Y such that Y dominates X).  There are several equivalent
     *           ways of stating this property...
     *           
-    * status: TODO
+    * status: DONE
     *
     * REQUIREMENTS:
     *    - the list must be unaltered
@@ -285,31 +1104,12 @@ class TravelOptions{
     *    - RUNTIME:  quadratic in number of options n (i.e., O(n^2)).
     *
     * REMEMBER:  the list does not need to be sorted in order to be pareto
+    *
+    * CACHED:  see is_sorted.  On a sorted list the answer is the same as is_pareto_sorted, so the
+    *          quadratic scan only runs for unsorted lists.
     */
     bool is_pareto() const{
-        Node *p = front;
-        
-        //reads through the whole linked list
-        while(p != nullptr && p->next != nullptr)
-        {
-            Node *q = p;
-            while(q->next != nullptr)
-            {
-                if(p != q->next)
-                {
-                    q->next = q->next->next;
-                    return true;
-                }
-                else
-                {
-                    return false;
-                }
-        
-            }
-        
-        }
-	return false;
-
+        return invariant(PARETO);
     }
 
     /**
@@ -321,125 +1121,196 @@ class TravelOptions{
     * REQUIREMENTS:
     *   RUNTIME:  linear in length of list n (i.e., O(n)).
     *
-    * status:  TODO
+    * status:  DONE
     *
     * COMMENTS:  notice that because of the runtime requirement, you cannot simply do this:
     *
                    return is_sorted() && is_pareto();
 
+    * CACHED:  see is_sorted.  This is the precondition check of most operations; all of the
+    *          operations that produce a pareto-sorted list record it, so the check is O(1) on them.
     */
     bool is_pareto_sorted() const{
-        while(front != nullptr && front->next != nullptr)
-        {
-        while(price != nullptr && price->next != nullptr)
-        {
-            if(price < price->next)
-            {
-                return true;
-                
-            }
-            else
-            {
-                return false;
-            }
-        }
-        while(time != nullptr && time->next != nullptr)
-        {
-            if(time > time->next)
-            {
-                return true;
-            }
-            else
-            {
-                return false;
-            }
-            
-        }
-        }
-    return false;
-
+        return invariant(PARETO_SORTED);
     }
 
+  private:
+
     /**
-     * func: insert_sorted
-     * preconditions:  given collection (calling object) must be sorted (but not necessarily
-     *                   pareto).  If this is not the case, false is returned (code provided).
-     *                   (returns true otherwise, after insertion complete).                 
+     * Invariant flags.  _known says which of the three properties are known for the current
+     * list and _holds says whether they hold.  Mutators that can tell the effect of their change
+     * update the flags directly (e.g., insert_pareto_sorted keeps a pareto-sorted list pareto-sorted,
+     * push_front only needs to look at the old front); anything else forgets the flag and the next
+     * query rescans.
+     *
+     * Define TRVL_DEBUG_FLAGS to cross-check every answer against a full scan.
+     */
+    enum Invariant { SORTED=1, PARETO=2, PARETO_SORTED=4, ALL_INVARIANTS=7 };
+
+    /**
+     * func: invariant
+     * desc: private utility; cached value of one invariant flag (scanning only if unknown).
+     * status: DONE
+     */
+    bool invariant(unsigned char bit) const {
+        if(!(_known & bit)) {
+            bool holds;
+            if(bit == SORTED)
+                holds = scan_sorted();
+            else if(bit == PARETO_SORTED)
+                holds = scan_pareto_sorted();
+            else if(invariant(SORTED))
+                holds = invariant(PARETO_SORTED);  //sorted: pareto iff pareto-sorted
+            else
+                holds = scan_pareto();
+            note(bit, holds);
+        }
+#ifdef TRVL_DEBUG_FLAGS
+        bool scanned = bit == SORTED ? scan_sorted() :
+                       bit == PARETO ? scan_pareto() : scan_pareto_sorted();
+        assert(((_holds & bit) != 0) == scanned);
+#endif
+        return (_holds & bit) != 0;
+    }
+
+    /**
+     * func: note
+     * desc: private utility; records that the given flag(s) are known to hold (or not) and
+     *       derives what follows from it:  pareto-sorted <=> sorted AND pareto.
+     * status: DONE
+     */
+    void note(unsigned char bits, bool holds) const {
+        _known |= bits;
+        if(holds)
+            _holds |= bits;
+        else
+            _holds &= ~bits;
+
+        if(_known & _holds & PARETO_SORTED) {
+            _known |= SORTED | PARETO;
+            _holds |= SORTED | PARETO;
+        }
+        if((_known & _holds & SORTED) && (_known & PARETO_SORTED) && !(_known & PARETO))
+            note(PARETO, (_holds & PARETO_SORTED) != 0);
+        if((_known & _holds & SORTED) && (_known & _holds & PARETO) && !(_known & PARETO_SORTED))
+            note(PARETO_SORTED, true);
+        if(((_known & SORTED) && !(_holds & SORTED)) || ((_known & PARETO) && !(_holds & PARETO)))
+            if(!(_known & PARETO_SORTED))
+                note(PARETO_SORTED, false);
+    }
+
+    /**
+     * func: scan_sorted / scan_pareto / scan_pareto_sorted
+     * desc: private; the full scans behind is_sorted, is_pareto and is_pareto_sorted.
+     * status: DONE
+     */
+    bool scan_sorted()const{
+        TRVL_STAT_OP(SCAN_SORTED);
+        Node *p = front;
+
+        while(p != nullptr && p->next != nullptr)
+        {
+            TRVL_STAT(NODES_VISITED, 1);
+            TRVL_STAT(COMPARES, 1);
+            Node *q = p->next;
+            if(p->price > q->price)
+            {
+                return false;
+            }
+            else if(p->price == q->price && p->time > q->time)
+            {
+                return false;
+            }
+            p = q;
+        }
+	return true;
+
+    }
+
+    bool scan_pareto() const{
+        TRVL_STAT_OP(SCAN_PARETO);
+        //dominance kernels over the contiguous snapshot (see Dominance.h)
+        const PriceIndex &idx = index();
+        TRVL_STAT(NODES_VISITED, idx.price.size());
+        TRVL_STAT(COMPARES, idx.price.size() <= 256 ? idx.price.size() * idx.price.size() : idx.price.size());  //at most
+        return dominance::is_pareto(idx.price.data(), idx.time.data(), idx.price.size());
+    }
+
+    bool scan_pareto_sorted() const{
+        TRVL_STAT_OP(SCAN_PARETO_SORTED);
+        Node *p = front;
+
+        while(p != nullptr && p->next != nullptr)
+        {
+            TRVL_STAT(NODES_VISITED, 1);
+            TRVL_STAT(COMPARES, 1);
+            if(p->price >= p->next->price || p->time <= p->next->time)
+            {
+                return false;
+            }
+            p = p->next;
+        }
+    return true;
+
+    }
+
+  public:
+
+    /**
+     * func: insert_sorted
+     * preconditions:  given collection (calling object) must be sorted (but not necessarily
+     *                   pareto).  If this is not the case, false is returned (code provided).
+     *                   (returns true otherwise, after insertion complete).                 
      *                 
      * desc:  inserts option <price,time> (given as parameters) into option list (calling object)
      *          while keeping it sorted.  Recall:  ordering by price; tie-breaker is time.
      *
      * RUNTIME:  linear in length of list -- O(n).
      *
-     * status: TODO
+     * status: DONE
      *
      * NOTES/TIPS:  do this before insert_pareto_sorted; it is easier!  Remember, this one
      *     you don't have to think about pruning for this function -- just ordering.
      */
 
-    bool insert_sorted(double price, double time) {
+    bool insert_sorted(Price price, Time time) {
+       TRVL_STAT_OP(INSERT_SORTED);
        if(!is_sorted()) return false;
+        Node *prev=nullptr;
         Node *curr=front;
-        Node *prev=front;
-        Node nnode=new Node;
-        nnode.price=price;
-        nnode.time=time;
-        bool isDone=false;
-        if (front==nullptr){
-            front=nnode;
-            return true;
-        }
-        if (compare(front,nnode)==worse){
-            nnode->next=front;
-            front=nnode;
-            return true;
-        }
-        while(curr->next!=nullptr && !isDone){
-            Relationship status= compare(curr,nnode);
-            if (status==better){
+
+        //skip every option that belongs before the new one
+        while(curr!=nullptr){
+            TRVL_STAT(NODES_VISITED, 1);
+            TRVL_STAT(COMPARES, 1);
+            if(curr->price < price || (curr->price == price && curr->time <= time)){
                 prev=curr;
                 curr=curr->next;
             }
-            if (status==worse || status==equal){
-                prev.next=nnode;
-                nnode.next=curr;
-                return true;
+            else{
+                break;
             }
         }
-        if (isDone==false){
-            curr->next=nnode;
-            return true;
+        Node *nnode=new_node(price, time, curr);
+        if(prev==nullptr){
+            front=nnode;
         }
-        return false;
-    }
-       /*
-       while(price != nullptr && time != nullptr)
-       {
-           if(price > price->next)
-           {
-               price = price->next;
-           }
-           else if(price == price->next)
-           {
-               if(time > time->next)
-               {
-                   time = time->next;
-               }
-               else
-               {
-                   return true;
-               }
-           }
-           else
-           {
-               return true;
-           }
-           
-       }
-
-       return true;
+        else{
+            prev->next=nnode;
+        }
+        _size++;
+        drop_index();
+
+        //still sorted; still pareto-sorted only if strictly between its neighbors
+        unsigned char known=_known, holds=_holds;
+        bool strict=(prev==nullptr || (prev->price<price && prev->time>time)) &&
+                    (curr==nullptr || (price<curr->price && time>curr->time));
+        _known=0;
+        note(SORTED, true);
+        if(known & PARETO_SORTED)
+            note(PARETO_SORTED, (holds & PARETO_SORTED) && strict);
+        return true;
     }
-    */
 
     /**
      * func: insert_pareto_sorted
@@ -462,21 +1333,121 @@ class TravelOptions{
      *         (but you still return true if preconditions are met).
      *    You must maintain sorted order and don't forget to deallocate memory associated
      *         with any deleted nodes.
-     * status: TODO
+     * status: DONE
      */
-    bool insert_pareto_sorted(double price, double time) {
+    bool insert_pareto_sorted(Price price, Time time) {
+      TRVL_STAT_OP(INSERT_PARETO_SORTED);
       if(!is_pareto_sorted()) return false;
 
+      Node *prev = nullptr;
+      Node *curr = front;
 
+      //find the first option that is not strictly cheaper
+      while(curr != nullptr && curr->price < price) {
+        TRVL_STAT(NODES_VISITED, 1);
+        prev = curr;
+        curr = curr->next;
+      }
+      TRVL_STAT(COMPARES, 2);
+      //the cheaper neighbor is the fastest of all cheaper options
+      if(prev != nullptr && prev->time <= time) {
+        TRVL_STAT(PRUNED, 1);
+        return true;
+      }
+      //same price, no slower
+      if(curr != nullptr && curr->price == price && curr->time <= time) {
+        TRVL_STAT(PRUNED, 1);
+        return true;
+      }
 
-            // your code here!
-
-
+      Node *nnode = new_node(price, time, curr);
+      if(prev == nullptr)
+        front = nnode;
+      else
+        prev->next = nnode;
+      _size++;
+      drop_index();
+
+      //everything after the new option is at least as expensive; drop the slower ones
+      while(nnode->next != nullptr && nnode->next->time >= time) {
+        Node *dead = nnode->next;
+        nnode->next = dead->next;
+        free_node(dead);
+        _size--;
+        TRVL_STAT(NODES_VISITED, 1);
+        TRVL_STAT(PRUNED, 1);
+      }
       return true;
     }
 
     
 
+    /**
+     * func: insert_pareto_sorted_batch
+     * preconditions:  given collection (calling object) must be sorted AND pareto (pruned).
+     *                 if this is not the case, false is returned (and the list is unchanged).
+     * desc: same result as calling insert_pareto_sorted once per <price,time> pair in batch
+     *       (e.g., a burst of fare updates), but the precondition is checked once and the list
+     *       is walked once:
+     *            - the batch is copied, sorted and pruned to its own pareto frontier;
+     *            - the batch frontier and the list are merged in one pass, relinking the existing
+     *                nodes in place; existing options that are now dominated are deleted and
+     *                only surviving batch options get new nodes.
+     *
+     * RUNTIME:  O(n + b log b) for a list of n options and a batch of b options
+     *           (vs. O(n b) for b separate insert_pareto_sorted calls)
+     * status: DONE
+     */
+    bool insert_pareto_sorted_batch(const std::vector<std::pair<Price, Time>> &batch) {
+      TRVL_STAT_OP(INSERT_PARETO_SORTED_BATCH);
+      if(!is_pareto_sorted()) return false;
+
+      std::vector<std::pair<Price, Time>> b(batch);
+      pareto_sweep(b);
+
+      Node *p = front;
+      Node *tail = nullptr;
+      size_t i = 0;
+
+      front = nullptr;
+      _size = 0;
+      drop_index();
+      while(p != nullptr || i < b.size()) {
+        Node *cand;
+        TRVL_STAT(COMPARES, 1);
+        //take the smaller option by <price,time> order; existing nodes win ties
+        if(i == b.size() || (p != nullptr && (p->price < b[i].first ||
+                             (p->price == b[i].first && p->time <= b[i].second)))) {
+          cand = p;
+          p = p->next;
+          TRVL_STAT(NODES_VISITED, 1);
+          if(tail != nullptr && cand->time >= tail->time) {
+            TRVL_STAT(PRUNED, 1);
+            free_node(cand);
+            continue;
+          }
+        }
+        else {
+          if(tail != nullptr && b[i].second >= tail->time) {
+            TRVL_STAT(PRUNED, 1);
+            i++;
+            continue;
+          }
+          cand = new_node(b[i].first, b[i].second);
+          i++;
+        }
+        if(tail == nullptr)
+          front = cand;
+        else
+          tail->next = cand;
+        tail = cand;
+        _size++;
+      }
+      if(tail != nullptr)
+        tail->next = nullptr;
+      return true;
+    }
+
    /**
    * func: union_pareto_sorted
    * precondition:  calling object and parameter collections must both be sorted and pareto (if not, nullptr is returned).
@@ -489,20 +1460,174 @@ class TravelOptions{
    *        candidate for the 2nd option (if any).  
    *        Remember:  a pareto-sorted list must be strictly increasing and price and strictly decreasing in time.
    * 
-   * status:  TODO
+   * status:  DONE
    * 
    */
-    TravelOptions * union_pareto_sorted(const TravelOptions &other)const{
+    BasicTravelOptions * union_pareto_sorted(const BasicTravelOptions &other)const{
  	if(!is_pareto_sorted() || !other.is_pareto_sorted())
 	  return nullptr;
+        BasicTravelOptions *result = new BasicTravelOptions();
+        union_pareto_sorted(other, *result);
+        return result;
+   }
+
+   /**
+   * func: union_pareto_sorted (into out)
+   * precondition:  as union_pareto_sorted (if not met, false is returned and out is unchanged).
+   * desc: same union, but the result replaces the contents of out (whose nodes are reused).  out may be the
+   *               calling object or the parameter.
+   * RUNTIME:  O(n+m)
+   * status:  DONE
+   */
+    bool union_pareto_sorted(const BasicTravelOptions &other, BasicTravelOptions &out) const {
+ 	TRVL_STAT_OP(UNION_PARETO_SORTED);
+ 	if(!is_pareto_sorted() || !other.is_pareto_sorted())
+	  return false;
+        if(&out == this || &out == &other) {
+          BasicTravelOptions tmp;
+          union_pareto_sorted(other, tmp);
+          out.swap_list(tmp);
+          return true;
+        }
 
+        Rewriter w(out);
+        Node *a = front;
+        Node *b = other.front;
+        Time last = Time();
+
+        while(a != nullptr || b != nullptr) {
+          Node *next;
+          //take the smaller option by <price,time> order
+          if(b == nullptr || (a != nullptr && (a->price < b->price ||
+                              (a->price == b->price && a->time <= b->time)))) {
+            next = a;
+            a = a->next;
+          }
+          else {
+            next = b;
+            b = b->next;
+          }
+          TRVL_STAT(NODES_VISITED, 1);
+          TRVL_STAT(COMPARES, 1);
+          //kept only if strictly faster than the last (cheaper) option kept
+          if(w.count() == 0 || next->time < last) {
+            w.append(next->price, next->time);
+            last = next->time;
+          }
+          else {
+            TRVL_STAT(PRUNED, 1);
+          }
+        }
+        w.finish(ALL_INVARIANTS, ALL_INVARIANTS);
+        return true;
+   }
 
+   /**
+   * func: union_pareto_sorted_k
+   * precondition:  every list is non-null and sorted-pareto (if not, nullptr is returned).
+   * desc: the sorted, pareto union of k collections (e.g., one frontier per carrier) as a newly created
+   *               object, in one pass:  a k-way merge with a heap holding the current option of each list.
+   *               Options come off the heap in <price,time> order and each one is kept iff it is
+   *               strictly faster than the last option kept, so dominated options and duplicates are
+   *               dropped as they are merged (no intermediate unions).
+   * RUNTIME:  O(N log k) where N is the total number of options
+   * status:  DONE
+   */
+    static BasicTravelOptions * union_pareto_sorted_k(const std::vector<const BasicTravelOptions *> &lists) {
+        TRVL_STAT_OP(UNION_PARETO_SORTED_K);
+        std::vector<Node *> heads;
+
+        for(size_t k = 0; k < lists.size(); k++) {
+          if(lists[k] == nullptr || !lists[k]->is_pareto_sorted())
+            return nullptr;
+          heads.push_back(lists[k]->front);
+        }
+        return merge_k(heads, false);
+    }
 
+   /**
+   * func: splice_union_pareto_sorted_k
+   * precondition:  every list is non-null, sorted-pareto and appears only once (if not, nullptr is returned).
+   * desc: same union as union_pareto_sorted_k, but built out of the given lists' own nodes:  surviving
+   *               nodes are relinked into the returned object and dominated ones are deleted.  In the
+   *               spirit of split_sorted_pareto, NO NEW NODES are allocated.  All given lists are left
+   *               empty.
+   * RUNTIME:  O(N log k)
+   * status:  DONE
+   */
+    static BasicTravelOptions * splice_union_pareto_sorted_k(const std::vector<BasicTravelOptions *> &lists) {
+        TRVL_STAT_OP(UNION_PARETO_SORTED_K);
+        std::vector<BasicTravelOptions *> seen(lists);
+        std::vector<Node *> heads;
+
+        std::sort(seen.begin(), seen.end());
+        if(std::adjacent_find(seen.begin(), seen.end()) != seen.end())
+          return nullptr;
+        for(size_t k = 0; k < lists.size(); k++) {
+          if(lists[k] == nullptr || !lists[k]->is_pareto_sorted())
+            return nullptr;
+          heads.push_back(lists[k]->front);
+        }
+        for(size_t k = 0; k < lists.size(); k++) {
+          lists[k]->front = nullptr;
+          lists[k]->_size = 0;
+          lists[k]->drop_index();
+        }
+        return merge_k(heads, true);
+    }
 
+  private:
 
-   
-        return nullptr;
-   }
+   /**
+   * func: merge_k
+   * desc: private driver for the k-way unions.  heads are the fronts of pareto-sorted chains.
+   *               With splice, the chains' nodes are reused (or deleted when dominated);
+   *               otherwise they are only read and survivors are copied.
+   * status:  DONE
+   */
+    static BasicTravelOptions * merge_k(const std::vector<Node *> &heads, bool splice) {
+        struct After {
+          bool operator()(const Node *x, const Node *y) const {
+            return x->price > y->price || (x->price == y->price && x->time > y->time);
+          }
+        };
+        std::priority_queue<Node *, std::vector<Node *>, After> heap;
+        BasicTravelOptions *result = new BasicTravelOptions();
+        Node *tail = nullptr;
+
+        for(size_t k = 0; k < heads.size(); k++) {
+          if(heads[k] != nullptr)
+            heap.push(heads[k]);
+        }
+        while(!heap.empty()) {
+          Node *p = heap.top();
+          Node *next = p->next;
+          heap.pop();
+          if(next != nullptr)
+            heap.push(next);
+
+          TRVL_STAT(NODES_VISITED, 1);
+          TRVL_STAT(COMPARES, 1);
+          if(tail == nullptr || p->time < tail->time) {
+            Node *nnode = splice ? p : new_node(p->price, p->time);
+            nnode->next = nullptr;
+            if(tail == nullptr)
+              result->front = nnode;
+            else
+              tail->next = nnode;
+            tail = nnode;
+            result->_size++;
+          }
+          else {
+            TRVL_STAT(PRUNED, 1);
+            if(splice)
+              free_node(p);
+          }
+        }
+        return result;
+    }
+
+  public:
     
    /**
    * func:  prune_sorted
@@ -511,30 +1636,69 @@ class TravelOptions{
    *         (and eliminates any duplicates).
    * RUNTIME:  linear in the length of the list (O(n))
    * COMMENTS:  the resulting list will be sorted AND pareto.
-   * status:  TODO
+   * status:  DONE
    * 
    */
     bool prune_sorted(){
+       TRVL_STAT_OP(PRUNE_SORTED);
        if(!is_sorted()) return false;
-       Node *p=head;
-        Node *n=head->next;
-        while (n->next!=nullptr){
-            if (p.price == n.price){
-                if (p.time == p.time){
-                    p->next=n->next;
-                    delete n;
-                    n=p->next;
-                }
+        Node *p=front;
+
+        while (p!=nullptr && p->next!=nullptr){
+            Node *n=p->next;
+            TRVL_STAT(NODES_VISITED, 1);
+            TRVL_STAT(COMPARES, 1);
+            //n is at least as expensive as p; it survives only if strictly faster
+            if (n->time >= p->time){
+                p->next=n->next;
+                free_node(n);
+                _size--;
+                TRVL_STAT(PRUNED, 1);
             }
-            if (p.price != n.price || p.time != n.time){
-                n=n->next;
-                p=p->next;
+            else{
+                p=n;
             }
         }
+       _known = _holds = ALL_INVARIANTS;
+       drop_index();
+       return true;
+    }
 
+   /**
+   * func:  prune_epsilon
+   * precondition:  the list is sorted-pareto with no negative price or time, and eps_price, eps_time >= 0
+   *                (if not, false is returned).
+   * desc: thins a frontier of nearly identical options down to an epsilon-pareto subset:  every option
+   *         removed has a remaining option that costs at most (1+eps_price) times as much and takes at most
+   *         (1+eps_time) times as long.  The options kept are original options (none are invented), so the
+   *         list stays sorted-pareto.  With eps_price = eps_time = 0.01 a frontier keeps at most about
+   *         log(t_max/t_min) / log(1.01) options, however many cent-apart options it had.
+   *
+   *         The second form also reports the worst relative error actually introduced, in price and in time
+   *         (each at most the corresponding eps).
+   * RUNTIME:  linear in the length of the list (O(n)) -- a single greedy pass (see epsilon_sweep)
+   * status:  DONE
+   */
+    bool prune_epsilon(double eps_price, double eps_time) {
+       double err_price, err_time;
+       return prune_epsilon(eps_price, eps_time, err_price, err_time);
+    }
 
-
-
+    bool prune_epsilon(double eps_price, double eps_time, double &err_price, double &err_time) {
+       TRVL_STAT_OP(PRUNE_EPSILON);
+       if (!is_pareto_sorted() || !(eps_price >= 0) || !(eps_time >= 0))
+           return false;
+
+       std::vector<std::pair<Price, Time>> buf;
+       to_vec(buf);
+       if (!buf.empty() && (buf.front().first < 0 || buf.back().second < 0))
+           return false;
+       epsilon_sweep(buf, eps_price, eps_time, err_price, err_time);
+
+       Rewriter w(*this);
+       for (size_t i=0; i<buf.size(); i++)
+           w.append(buf[i].first, buf[i].second);
+       w.finish(ALL_INVARIANTS, ALL_INVARIANTS);
        return true;
     }
 
@@ -564,11 +1728,22 @@ class TravelOptions{
    *       as a pointer to the object.
    * returns:  a pointer to a TravelOptions object capturing all non-dominated options for the entire trip from X-to-Z
    *              (i.e., even though the given lists may not be sorted or pareto, the resulting list will be both).
+   *              With integer Price / Time types, nullptr if a total price or time does not fit the type
+   *              (see option_sum; never for double).
+   *
+   * status:  DONE
+   * RUNTIME:  no runtime requirement; this version is output-sensitive:
    *
-   * status:  TODO
-   * RUNTIME:  no runtime requirement 
+   *       Both lists are first reduced to their sorted-pareto frontiers A (n options) and B (m options),
+   *       n <= m.  For a fixed a in A, the sums a+B are themselves pareto-sorted, so the answer is the
+   *       pareto merge of n sorted rows.  The rows are merged in price order with a heap of n cursors;
+   *       a popped sum is kept iff it is faster than the last one kept.  When a row's sum is dominated,
+   *       its cursor jumps (binary search) straight to the first option of the row that beats the best
+   *       time so far instead of stepping through every dominated pairing.  Cost is
+   *       O((n + m) log(n + m)) to prune plus O(log n + log m) per heap step, and the number of heap
+   *       steps tracks the output frontier rather than N x M.
    *
-   * TIPS:  
+   * TIPS (original brute force):  
    *       Start by thinking about the "cross-product" of the two option lists (i.e., enumerating all pairs).
    *       Leverage some of the other operations in this assignment -- insert_pareto_sorted might be especially useful!
    *          (probably ought to implement any functions you plan on using first!).
@@ -578,21 +1753,276 @@ class TravelOptions{
    *    well-defined (also empty).  An empty option list is NOT the same as a null pointer though -- you should still return
    *   a pointer to a new TravelOptions object -- that object just happens to have an empty list.
    */
-   TravelOptions * join_plus_plus(const TravelOptions &other) const {
-       //first attempt at this function. gonna come back to it  
-       Node *p=front;
-         TravelOptions tr=other;
-         while (p->next!=nullptr){
-             //TODO: combine the prices and times of p and tr and place result into p.
-             tr.insert_pareto_sorted(p);
-             p=p->next;
-        }
-	    
+   BasicTravelOptions * join_plus_plus(const BasicTravelOptions &other) const {
+       TRVL_STAT_OP(JOIN_PLUS_PLUS);
+       std::vector<std::pair<Price, Time>> a = pareto_frontier(), b = other.pareto_frontier(), out;
+
+       if (!sums_fit(a, b))
+           return nullptr;
+       merge_plus_plus(a, b, out);
+       return from_vec(out);
+   }
 
-      return tr;
+   /**
+   * func: join_plus_plus (into out)
+   * desc: same join as above, but the result replaces the contents of out (whose nodes are reused).  out
+   *       may be the calling object or the parameter.
+   * returns: false (out unchanged) if a total does not fit the Price / Time type; true otherwise
+   * status:  DONE
+   */
+   bool join_plus_plus(const BasicTravelOptions &other, BasicTravelOptions &out) const {
+       TRVL_STAT_OP(JOIN_PLUS_PLUS);
+       std::vector<std::pair<Price, Time>> a = pareto_frontier(), b = other.pareto_frontier(), res;
+
+       if (!sums_fit(a, b))
+           return false;
+       merge_plus_plus(a, b, res);
+       Rewriter w(out);
+       for (size_t i=0; i<res.size(); i++)
+           w.append(res[i].first, res[i].second);
+       w.finish(ALL_INVARIANTS, ALL_INVARIANTS);
+       return true;
+   }
+
+   /**
+   * func: JoinView
+   * desc: lazy join_plus_plus of two sorted-pareto lists (see join_plus_plus_view):  next() yields the options
+   *       of the joined frontier one at a time, cheapest first, and stops after the price cap.  A
+   *       PlusPlusMerge over the two lists' query snapshots (see index()), so the first k options cost about
+   *       O(k log k) heap work plus the jumps, not the full join.
+   *
+   *       The lists must outlive the view and must not change while it is in use.
+   */
+   class JoinView {
+       friend class BasicTravelOptions;
+
+       PlusPlusMerge<Price, Time> _merge;
+       Price _cap;
+       bool _capped;
+
+       JoinView(const PriceIndex &a, const PriceIndex &b, bool capped, Price cap)
+           : _merge(a.price.data(), a.time.data(), a.price.size(), b.price.data(), b.time.data(), b.price.size()),
+             _cap(cap), _capped(capped) {
+       }
 
+     public:
+       /**
+        * func: next
+        * desc: the next (pricier, faster) option of the joined frontier
+        * returns: false once the frontier is exhausted or the next option would cost more than the cap
+        */
+       bool next(Price &price, Time &time) {
+           TRVL_STAT_OP(JOIN_VIEW);
+           return _merge.next(price, time, _capped, _cap);
+       }
 
+       /**
+        * func: take
+        * desc: appends up to k more options (fewer at the end of the frontier or at the cap) to out
+        * returns: the number of options appended
+        */
+       size_t take(size_t k, std::vector<std::pair<Price, Time>> &out) {
+           Price p;
+           Time t;
+           size_t n = 0;
+
+           while (n < k && next(p, t)) {
+               out.push_back(std::pair<Price, Time>(p, t));
+               n++;
+           }
+           return n;
+       }
 
+       // options returned so far
+       size_t count() const {
+           return _merge.count();
+       }
+   };
+
+   /**
+   * func: join_plus_plus_view
+   * preconditions:  both lists are sorted-pareto (if not, nullptr is returned).
+   * desc: a lazy view of join_plus_plus(other) (see JoinView) that yields its options cheapest first, e.g.
+   *       the 10 cheapest itineraries without computing the rest.  With max_price, the view stops at the
+   *       last option with price <= max_price.
+   * returns: pointer to a new JoinView (the caller deletes it); nullptr if a precondition fails or (with
+   *       integer Price / Time types) a total does not fit the type, as in join_plus_plus.
+   * RUNTIME:  O(1) to create when both query snapshots are up to date (else O(n + m) once to build them);
+   *       then see JoinView.
+   * status:  DONE
+   */
+   JoinView * join_plus_plus_view(const BasicTravelOptions &other) const {
+       return join_view(other, false, Price());
+   }
+
+   JoinView * join_plus_plus_view(const BasicTravelOptions &other, Price max_price) const {
+       return join_view(other, true, max_price);
+   }
+
+   /**
+   * func: join_plus_plus_epsilon
+   * preconditions:  no negative prices or times in either list, eps_price, eps_time >= 0 (if not, nullptr is
+   *                 returned).  The lists do not need to be sorted or pareto.
+   * desc: approximate join_plus_plus:  the result is an epsilon-pareto subset of the exact join (every exact
+   *       option has a returned option within (1+eps_price) in price and (1+eps_time) in time), and every
+   *       returned option is a real pairing.
+   *
+   *       Both legs' frontiers are thinned with prune_epsilon's sweep before they are joined, which is
+   *       where the time goes:  with positive values, replacing a by a' and b by b' that are each within
+   *       (1+d) keeps a'+b' within (1+d) of a+b.  The joined frontier is thinned once more.  Each of the
+   *       two rounds uses d = sqrt(1+eps)-1, so the total stays within (1+eps).
+   *
+   *       The second form reports the worst-case error of the result:  (1+e_in)(1+e_out)-1 per criterion,
+   *       from the errors the two rounds actually introduced (never more than eps).
+   * returns: pointer to a new sorted-pareto TravelOptions object; nullptr if a precondition fails or a total
+   *       does not fit the Price / Time type.
+   * RUNTIME:  O(n log n + m log m) to find the frontiers, then join_plus_plus on the (much shorter) thinned
+   *       frontiers.
+   * status:  DONE
+   */
+   BasicTravelOptions * join_plus_plus_epsilon(const BasicTravelOptions &other, double eps_price,
+                                               double eps_time) const {
+       double err_price, err_time;
+       return join_plus_plus_epsilon(other, eps_price, eps_time, err_price, err_time);
+   }
+
+   BasicTravelOptions * join_plus_plus_epsilon(const BasicTravelOptions &other, double eps_price, double eps_time,
+                                               double &err_price, double &err_time) const {
+       TRVL_STAT_OP(JOIN_PLUS_PLUS_EPSILON);
+       if (!(eps_price >= 0) || !(eps_time >= 0))
+           return nullptr;
+
+       std::vector<std::pair<Price, Time>> a = pareto_frontier(), b = other.pareto_frontier(), out;
+       for (const std::vector<std::pair<Price, Time>> *f : {&a, &b}) {
+           if (!f->empty() && (f->front().first < 0 || f->back().second < 0))
+               return nullptr;
+       }
+       if (!sums_fit(a, b))
+           return nullptr;
+
+       double dp = std::sqrt(1+eps_price)-1, dt = std::sqrt(1+eps_time)-1;
+       double ap, at, bp, bt, op, ot;
+       epsilon_sweep(a, dp, dt, ap, at);
+       epsilon_sweep(b, dp, dt, bp, bt);
+       merge_plus_plus(a, b, out);
+       epsilon_sweep(out, dp, dt, op, ot);
+       err_price = (1+std::max(ap, bp)) * (1+op) - 1;
+       err_time = (1+std::max(at, bt)) * (1+ot) - 1;
+       return from_vec(out);
+   }
+
+   /**
+   * func: join_plus_plus_parallel
+   * param: other; the second leg, as in join_plus_plus.
+   * param: nthreads; number of threads to use (the calling thread counts as one); 0 means one per
+   *               hardware thread.
+   * desc: the same join as join_plus_plus (the result is identical), spread over several threads for very
+   *       large legs:
+   *
+   *         1.  the calling object's options are split into one chunk per thread; each chunk is reduced to
+   *             its pareto frontier (and, as one more task, so is other);
+   *         2.  each worker joins its chunk's frontier with other's frontier (the merge_plus_plus engine),
+   *             giving a pareto-sorted partial result; chunk options that the ends of the global frontier
+   *             dominate are dropped first, so overflow is decided on the global frontier, as in the serial
+   *             join;
+   *         3.  the partial results are combined pairwise, in rounds, by a parallel tree of pareto unions.
+   *
+   *       Every pairing <p1+p2,t1+t2> lands in exactly one chunk, and a pareto union keeps precisely the
+   *       options not dominated by the other side, so the final frontier is the serial one.
+   *       Legs too small to be worth the threads (or nthreads == 1) go straight to join_plus_plus.
+   *
+   *       Workers only touch vectors; TravelOptions nodes are allocated by the calling thread at the end.
+   * returns:  pointer to a new sorted-pareto TravelOptions object (empty if either list is empty); nullptr if a
+   *           total does not fit the Price / Time type (as in join_plus_plus).
+   * RUNTIME:  about join_plus_plus / nthreads for large legs, plus O(N log nthreads) for the unions.
+   * status:  DONE
+   */
+   BasicTravelOptions * join_plus_plus_parallel(const BasicTravelOptions &other, unsigned nthreads=0) const {
+       TRVL_STAT_OP(JOIN_PLUS_PLUS_PARALLEL);
+       const size_t grain = 4096;   // fewer options per chunk than this are not worth a thread
+
+       size_t most = _size / grain;
+
+       if (nthreads == 1 || most <= 1 || other._size == 0)
+           return join_plus_plus(other);
+       if (nthreads == 0)
+           nthreads = std::max(1u, std::thread::hardware_concurrency());
+       nthreads = (unsigned)std::min<size_t>(nthreads, most);
+       if (nthreads <= 1)
+           return join_plus_plus(other);
+
+       std::vector<std::pair<Price, Time>> mine;
+       for (Node *p = front; p != nullptr; p = p->next)
+           mine.push_back(std::pair<Price, Time>(p->price, p->time));
+
+       size_t k = nthreads;
+       std::vector<std::vector<std::pair<Price, Time>>> parts(k), chunks(k);
+       std::vector<std::pair<Price, Time>> legB;
+
+       // the threads are started once and reused by all the rounds below
+       Workers team(nthreads);
+
+       // 1. chunk frontiers (task k is other's frontier)
+       team.run(k+1, [&](size_t c) {
+           if (c == k) {
+               legB = other.pareto_frontier();
+               return;
+           }
+           size_t lo = mine.size() * c / k, hi = mine.size() * (c+1) / k;
+           chunks[c].assign(mine.begin() + lo, mine.begin() + hi);
+           pareto_sweep(chunks[c]);
+       });
+
+       // the ends of the calling object's global frontier:  the cheapest option (lexicographic minimum of the
+       // chunk fronts) and the fastest one (fewest time, then price, among the chunk backs).  sums_fit only
+       // looks at the ends, so this is the serial path's overflow check on the global frontier.
+       std::vector<std::pair<Price, Time>> ends;
+       for (size_t c=0; c<k; c++){
+           if (chunks[c].empty())
+               continue;
+           if (ends.empty()){
+               ends.push_back(chunks[c].front());
+               ends.push_back(chunks[c].back());
+               continue;
+           }
+           ends[0] = std::min(ends[0], chunks[c].front());
+           const std::pair<Price, Time> &b = chunks[c].back();
+           if (b.second < ends[1].second || (b.second == ends[1].second && b.first < ends[1].first))
+               ends[1] = b;
+       }
+       if (!sums_fit(ends, legB))
+           return nullptr;
+
+       // 2. chunk x other.  A chunk option pricier than the global fastest option or slower than the global
+       // cheapest one is dominated globally (the serial join never sums it, and it might not fit the type):
+       // each chunk is trimmed to the box spanned by the two ends first.
+       team.run(k, [&](size_t c) {
+           std::vector<std::pair<Price, Time>> &ch = chunks[c];
+           size_t lo = 0, hi = ch.size();
+           while (lo < hi && ch[lo].second > ends[0].second)
+               lo++;
+           while (hi > lo && ch[hi-1].first > ends[1].first)
+               hi--;
+           ch.erase(ch.begin() + hi, ch.end());
+           ch.erase(ch.begin(), ch.begin() + lo);
+           merge_plus_plus(ch, legB, parts[c]);
+           std::vector<std::pair<Price, Time>>().swap(ch);
+       });
+
+       // 3. tree of unions:  each round merges parts[i] and parts[i+step] into parts[i]
+       for (size_t step = 1; step < k; step *= 2) {
+           size_t pairs = (k + 2*step - 1) / (2*step);
+           team.run(pairs, [&](size_t c) {
+               size_t i = c * 2 * step;
+               if (i + step < k) {
+                   std::vector<std::pair<Price, Time>> merged;
+                   union_frontiers(parts[i], parts[i+step], merged);
+                   parts[i].swap(merged);
+                   std::vector<std::pair<Price, Time>>().swap(parts[i+step]);
+               }
+           });
+       }
+       return from_vec(parts[0]);
    }
 
 
@@ -616,7 +2046,13 @@ class TravelOptions{
    *       
    * RUNTIME:  let N and M be the lengths of the respective lists given; your runtime must be linear in N+M (O(N+M)).
    *
-   * status:  TODO
+   * status:  DONE
+   *
+   * ALGORITHM:  the first option pairs the two cheapest options.  The only way to lower MAX(t1,t2) is to move past
+   *      the slower side, so each step advances the cursor(s) holding the larger time; a step's pairing is kept if it
+   *      is strictly faster than the last one kept.  Stops when the slower side has no faster option left.  The
+   *      precondition check is the (linear, usually cached) is_pareto_sorted.  See also the overload below that
+   *      writes into a caller-provided object.
    *
    * TIPS:
    *      This one will take some thought!  If the specified runtime is possible, the resulting option list cannot be too
@@ -630,31 +2066,409 @@ class TravelOptions{
    *         traveling for 12 hours and child B traveling for 8 hours.  Does it make sense to spend more money on child B
    *         so they can get home in say 7 hours?  Think about it!  The MAX function is important!
    */
-   TravelOptions * join_plus_max(const TravelOptions &other) const {
+   BasicTravelOptions * join_plus_max(const BasicTravelOptions &other) const {
 
-	if(!is_pareto() || !(other.is_pareto()))
+	if(!is_pareto_sorted() || !(other.is_pareto_sorted()))
 		return nullptr;
-	
+	BasicTravelOptions *tr = new BasicTravelOptions();
+	if(!join_plus_max(other, *tr)) {
+		delete tr;
+		return nullptr;
+	}
+   	return tr;
+   }
+
+   /**
+   * func: join_plus_max (into out)
+   * preconditions:  both the calling object and the parameter are sorted-pareto lists (if not, false is returned
+   *                 and out is unchanged).
+   * desc: same as join_plus_max above, but the result replaces the contents of out.  out's existing nodes are
+   *       overwritten in place (extra ones are freed, missing ones are allocated), so repeated queries into the
+   *       same object reuse its nodes.  out may be the calling object or the parameter.
+   *       With an integer Price, false is also returned (and out is left empty, unless it is one of the inputs)
+   *       if a total price does not fit the type.
+   * RUNTIME:  O(N+M)
+   * status:  DONE
+   */
+   bool join_plus_max(const BasicTravelOptions &other, BasicTravelOptions &out) const {
+	TRVL_STAT_OP(JOIN_PLUS_MAX);
+	if(!is_pareto_sorted() || !(other.is_pareto_sorted()))
+		return false;
+	if(&out == this || &out == &other) {
+		BasicTravelOptions tmp;
+		if(!join_plus_max(other, tmp))
+			return false;
+		out.swap_list(tmp);
+		return true;
+	}
+
+	Rewriter w(out);
+	Node *a = front, *b = other.front;
+	Time last = Time();
+
+	while(a != nullptr && b != nullptr) {
+		Time t = std::max(a->time, b->time);
+
+		TRVL_STAT(NODES_VISITED, 1);
+		TRVL_STAT(COMPARES, 1);
+		if(w.count() == 0 || t < last) {
+			Price p;
+			if(!option_sum<Price>::add(a->price, b->price, p)) {
+				w.finish(ALL_INVARIANTS, ALL_INVARIANTS);
+				out.clear();
+				return false;
+			}
+			w.append(p, t);
+			last = t;
+		}
+		else {
+			TRVL_STAT(PRUNED, 1);
+		}
+		//lower the MAX:  move past the slower side (both on a tie)
+		bool adv_a = a->time >= b->time;
+		bool adv_b = b->time >= a->time;
+		if(adv_a) a = a->next;
+		if(adv_b) b = b->next;
+	}
+	w.finish(ALL_INVARIANTS, ALL_INVARIANTS);
+	return true;
+   }
+
+   /**
+   * func: chain_plus_plus
+   * desc: join_plus_plus over k legs at once:  legs[0] from X to Y, legs[1] from Y to Z, and so on.
+   *       Returns the sorted-pareto options for the whole trip (same as calling join_plus_plus
+   *       k-1 times and keeping the last result).
+   *
+   *       Plus-plus is associative and symmetric, so the legs can be joined in any order.  Each leg
+   *       is reduced to its pareto frontier, the frontiers are ordered smallest first and folded
+   *       left to right; small frontiers early keep the intermediate results small.  Intermediates
+   *       live in two buffers that are reused for every step (no TravelOptions per step); only the
+   *       final frontier is turned into a list.
+   *
+   * preconditions:  no null pointers in legs (if there are, nullptr is returned).  The legs do not
+   *                 need to be sorted or pareto.  As in join_plus_plus, nullptr is also returned if a
+   *                 total does not fit the Price / Time type.
+   * returns: pointer to a new TravelOptions object; empty if legs is empty or any leg is empty.
+   * status:  DONE
+   */
+   static BasicTravelOptions * chain_plus_plus(const std::vector<const BasicTravelOptions *> &legs) {
+       TRVL_STAT_OP(CHAIN_PLUS_PLUS);
+       std::vector<std::vector<std::pair<Price, Time>>> frontiers;
+
+       for (size_t k=0; k<legs.size(); k++){
+           if (legs[k]==nullptr)
+               return nullptr;
+           frontiers.push_back(legs[k]->pareto_frontier());
+       }
+       if (frontiers.empty())
+           return new BasicTravelOptions();
+
+       std::vector<size_t> order(frontiers.size());
+       for (size_t k=0; k<order.size(); k++)
+           order[k]=k;
+       std::stable_sort(order.begin(), order.end(), [&frontiers](size_t x, size_t y) {
+           return frontiers[x].size() < frontiers[y].size();
+       });
+
+       std::vector<std::pair<Price, Time>> acc, tmp;
+       acc.swap(frontiers[order[0]]);
+       for (size_t k=1; k<order.size() && !acc.empty(); k++){
+           if (!sums_fit(acc, frontiers[order[k]]))
+               return nullptr;
+           merge_plus_plus(acc, frontiers[order[k]], tmp);
+           acc.swap(tmp);
+       }
+       return from_vec(acc);
+   }
+
+   /**
+   * func: chain_plus_max
+   * desc: join_plus_max over k parallel travelers:  every traveler picks one option from their own
+   *       list, the prices add up and the composite time is the MAX of the times (when everybody is
+   *       home).  Joined smallest list first, like chain_plus_plus; the intermediates ping-pong between two
+   *       TravelOptions objects through the join_plus_max overload that writes into (and reuses the nodes of)
+   *       its output.
+   *
+   * preconditions:  every list is non-null and sorted-pareto (if not, nullptr is returned).  nullptr is
+   *                 also returned if a total price does not fit the Price type.
+   * returns: pointer to a new TravelOptions object; empty if lists is empty or any list is empty.
+   * RUNTIME:  O(total length of the lists) per merge.
+   * status:  DONE
+   */
+   static BasicTravelOptions * chain_plus_max(const std::vector<const BasicTravelOptions *> &lists) {
+       TRVL_STAT_OP(CHAIN_PLUS_MAX);
+       for (size_t k=0; k<lists.size(); k++){
+           if (lists[k]==nullptr || !lists[k]->is_pareto_sorted())
+               return nullptr;
+       }
+       if (lists.size()==1)
+           return new BasicTravelOptions(*lists[0]);   //node-for-node copy; the flags come along
+
+       std::vector<const BasicTravelOptions *> order(lists);
+       std::stable_sort(order.begin(), order.end(), [](const BasicTravelOptions *x, const BasicTravelOptions *y) {
+           return x->size() < y->size();
+       });
+
+       BasicTravelOptions *acc=new BasicTravelOptions();
+       BasicTravelOptions tmp;
+       bool fit = true;
+       if (order.size()>1)
+           fit = order[0]->join_plus_max(*order[1], *acc);
+       for (size_t k=2; k<order.size() && acc->size()>0 && fit; k++){
+           fit = acc->join_plus_max(*order[k], tmp);
+           acc->swap_list(tmp);
+       }
+       if (!fit){
+           delete acc;
+           return nullptr;
+       }
+       return acc;
+   }
+
+  private:
+
+   /**
+   * func: join_view
+   * desc: private; builds the JoinView behind join_plus_plus_view (PlusPlusMerge lets the shorter list drive
+   *       the rows).
+   * status:  DONE
+   */
+   JoinView * join_view(const BasicTravelOptions &other, bool capped, Price max_price) const {
+       if (!is_pareto_sorted() || !other.is_pareto_sorted())
+           return nullptr;
+       const PriceIndex &a = index(), &b = other.index();
+       if (!a.price.empty() && !b.price.empty()) {
+           Price p;
+           Time t;
+           if (!option_sum<Price>::add(a.price.front(), b.price.front(), p) ||
+               !option_sum<Price>::add(a.price.back(), b.price.back(), p) ||
+               !option_sum<Time>::add(a.time.front(), b.time.front(), t) ||
+               !option_sum<Time>::add(a.time.back(), b.time.back(), t))
+               return nullptr;
+       }
+       return new JoinView(a, b, capped, max_price);
+   }
+
+   /**
+   * func: merge_runs
+   * desc: private utility of sort_nodes; merges two sorted chains by relinking them (on ties a's nodes
+   *       go first, which keeps the sort stable).  With prune, a node is linked only if it is strictly
+   *       faster than the last one linked (as in prune_sorted); the others are freed and counted in
+   *       dropped.
+   * returns: the head of the merged chain
+   * status:  DONE
+   */
+   static Node * merge_runs(Node *a, Node *b, bool prune, size_t &dropped) {
+       Node *head = nullptr, **link = &head, *tail = nullptr;
+
+       while(a != nullptr || b != nullptr) {
+           Node *e;
+           TRVL_STAT(NODES_VISITED, 1);
+           TRVL_STAT(COMPARES, 1);
+           if(a == nullptr || (b != nullptr &&
+                               (b->price < a->price || (b->price == a->price && b->time < a->time)))) {
+               e = b;
+               b = b->next;
+           }
+           else {
+               e = a;
+               a = a->next;
+           }
+           if(prune && tail != nullptr && e->time >= tail->time) {
+               TRVL_STAT(PRUNED, 1);
+               free_node(e);
+               dropped++;
+               continue;
+           }
+           *link = e;
+           link = &e->next;
+           tail = e;
+       }
+       *link = nullptr;
+       return head;
+   }
+
+   /**
+   * func: sort_nodes
+   * desc: private engine of sort_in_place / sort_and_prune_in_place; bottom-up merge sort of the node
+   *       chain.  run[i] holds a sorted run of 2^i nodes (or nothing); each node is taken off the list
+   *       as a run of one and carried up like a binary counter:  while run[i] is taken, the two are
+   *       merged (run[i], the earlier nodes, first) into a run for slot i+1.  Unlike merging whole
+   *       passes over the list, each merge works on nodes that were just touched, which keeps long
+   *       lists cache friendly.  At the end the runs are merged from the smallest up; with prune the
+   *       final merge (with an empty chain, if the largest run is all there is) also drops the
+   *       dominated options.
+   * RUNTIME:  O(n log n); the 64 run heads are the only extra memory
+   * status:  DONE
+   */
+   void sort_nodes(bool prune) {
+       unsigned char known = _known, holds = _holds;
+       Node *run[64] = { nullptr };
+       size_t dropped = 0, top = 0;
+       Node *p = front;
+
+       while(p != nullptr) {
+           Node *r = p;
+           size_t i = 0;
+
+           p = p->next;
+           r->next = nullptr;
+           for(; run[i] != nullptr; i++) {
+               r = merge_runs(run[i], r, false, dropped);
+               run[i] = nullptr;
+           }
+           run[i] = r;
+           if(i > top)
+               top = i;
+       }
+
+       Node *head = nullptr;
+       for(size_t i=0; i<=top; i++) {
+           if(run[i] != nullptr)
+               head = merge_runs(run[i], head, prune && i == top, dropped);
+       }
+       front = head;
+       _size -= dropped;
+       drop_index();
+
+       //the same set of options (or its frontier):  only the order-dependent flags change
+       _known = _holds = 0;
+       if(prune) {
+           note(ALL_INVARIANTS, true);
+       }
+       else {
+           note(SORTED, true);
+           if(known & PARETO)
+               note(PARETO, (holds & PARETO) != 0);
+       }
+   }
+
+   /**
+   * func: swap_list
+   * desc: private utility; exchanges the lists of the two objects in O(1) (nodes, size,
+   *       invariant flags and query snapshot all move together; nothing is copied).
+   * status:  DONE
+   */
+   void swap_list(BasicTravelOptions &other) {
+       std::swap(front, other.front);
+       std::swap(_size, other._size);
+       std::swap(_known, other._known);
+       std::swap(_holds, other._holds);
+       std::swap(_index, other._index);
+   }
+
+   /**
+   * func: Rewriter
+   * desc: private utility behind the "into out" overloads:  rewrites out front to back with the
+   *       appended options, overwriting out's existing nodes in place.  finish() frees the nodes
+   *       left over (or the new ones were allocated as needed) and records which invariant flags
+   *       are known for the result.  out must not be one of the lists being read.
+   * status:  DONE
+   */
+   class Rewriter {
+       BasicTravelOptions &_out;
+       Node *_reuse;    // out's old nodes not yet overwritten
+       Node **_link;    // where the next node goes
+       int _n;
+       int _old;        // out's size before the rewrite
+
+     public:
+       explicit Rewriter(BasicTravelOptions &out) : _out(out), _reuse(out.front), _link(&out.front), _n(0),
+                                                    _old(out._size) {}
+
+       int count() const { return _n; }
+
+       void append(Price price, Time time) {
+           Node *nnode = _reuse;
+           if(nnode != nullptr) {
+               _reuse = nnode->next;
+               nnode->price = price;
+               nnode->time = time;
+           }
+           else {
+               nnode = new_node(price, time);
+           }
+           *_link = nnode;
+           _link = &nnode->next;
+           _n++;
+       }
+
+       void finish(unsigned char known, unsigned char holds) {
+           TRVL_STAT(NODES_FREED, _old > _n ? _old - _n : 0);
+           *_link = nullptr;
+           free_chain(_reuse);
+           _reuse = nullptr;
+           _out._size = _n;
+           _out._known = known;
+           _out._holds = holds;
+           _out.drop_index();
+       }
+   };
+
+  public:
 
-   	return nullptr;
+   /**
+   * func: sort_in_place
+   * desc: sorts the list (see is_sorted) by relinking its own nodes:  no node is allocated, freed or
+   *       moved, so checksum() is unchanged.  Stable:  equal options keep their relative order.
+   * RUNTIME:  O(n log n) with O(1) extra memory (bottom-up merge sort, see sort_nodes); O(1) if the list
+   *       is already known to be sorted, O(n) if a scan finds it sorted.
+   * status:  DONE
+   */
+   void sort_in_place() {
+	TRVL_STAT_OP(SORT_IN_PLACE);
+	if(invariant(SORTED))
+	  return;
+	sort_nodes(false);
+   }
+
+   /**
+   * func: sort_and_prune_in_place
+   * desc: sort_in_place followed by prune_sorted, fused:  the last merge pass drops dominated options
+   *       (and duplicates) as it links the result, so the list ends up sorted AND pareto.  Nodes are
+   *       only freed, never allocated.
+   * RUNTIME:  O(n log n) with O(1) extra memory
+   * status:  DONE
+   */
+   void sort_and_prune_in_place() {
+	TRVL_STAT_OP(SORT_AND_PRUNE_IN_PLACE);
+	if(invariant(SORTED))
+	  prune_sorted();
+	else
+	  sort_nodes(true);
    }
 
    /**
    * func: sorted_clone
    * desc: returns a sorted TravelOptions object which contains the same elements as the current object
-   * status:  DONE [but relies on to do item insert_sorted]
+   * RUNTIME:  O(n log n) (a copy, then the sort_in_place merge sort)
+   * status:  DONE
    */
-   TravelOptions * sorted_clone() {
-	TravelOptions *sorted = new TravelOptions();
-	Node *p = front;
-	
-	while(p != nullptr) {
-	  sorted->insert_sorted(p->price, p->time);
-	  p = p->next;
- 	}
+   BasicTravelOptions * sorted_clone() {
+	TRVL_STAT_OP(SORTED_CLONE);
+	BasicTravelOptions *sorted = new BasicTravelOptions(*this);
+
+	//sort_nodes directly, so the call is recorded once (as sorted_clone)
+	if(!sorted->invariant(SORTED))
+	  sorted->sort_nodes(false);
 	return sorted;
    }
 
+   /**
+   * func: sorted_clone (into out)
+   * desc: out is replaced by a sorted copy of the calling object's options (out's nodes are reused).  out may
+   *       be the calling object itself, which then ends up sorted.
+   * RUNTIME:  O(n log n)
+   * status:  DONE
+   */
+   void sorted_clone(BasicTravelOptions &out) const {
+	TRVL_STAT_OP(SORTED_CLONE);
+	out = *this;
+	if(!out.invariant(SORTED))
+	  out.sort_nodes(false);
+   }
+
    /**
    * func: split_sorted_pareto
    * precondition:  given list must be both sorted and pareto (if not, nullptr is returned; 
@@ -672,34 +2486,162 @@ class TravelOptions{
    *        suppose your given list has 100 options and 40 of them are below the max_price threshold; 
    *        the other 60 options end up in the returnd list.  Still a grand total of 100 options and 
    *        therefore 100 nodes.  So... there should be no reason to delete or allocate any nodes. 
-   * status:  TODO
+   * status:  DONE
    */
-   TravelOptions * split_sorted_pareto(double max_price) {
+   BasicTravelOptions * split_sorted_pareto(Price max_price) {
 
 	if(!is_pareto_sorted())
 	  return nullptr;
-      Node *p=front;
-    //get to point where the max price is
-    while(p->next.price>=max_price){
+    BasicTravelOptions *tr=new BasicTravelOptions();
+    split_sorted_pareto(max_price, *tr);
+    return tr;
+   }
+
+   /**
+   * func: split_sorted_pareto (into out)
+   * precondition:  as split_sorted_pareto, and out is not the calling object (if not met, false is returned
+   *    and nothing changes).
+   * desc: same split, but the expensive options replace the contents of out (out's old options are deleted).
+   *    Still no new nodes.
+   * status:  DONE
+   */
+   bool split_sorted_pareto(Price max_price, BasicTravelOptions &out) {
+	TRVL_STAT_OP(SPLIT_SORTED_PARETO);
+
+	if(!is_pareto_sorted() || &out == this)
+	  return false;
+    Node *prev=nullptr;
+    Node *p=front;
+    int kept=0;
+
+    //get to the first option above the max price
+    while(p!=nullptr && p->price<=max_price){
+        TRVL_STAT(NODES_VISITED, 1);
+        prev=p;
         p=p->next;
+        kept++;
     }
-    //set pointer to the next one above the price
-    Node *temp=p->next;
-    //end list in current traveloptions
-    p->next=nullptr;
-    TravelOptions tr=new TravelOptions;
-    //insert the separated list into the new traveloptions object
-    while (temp->next!=nullptr){
-        tr.insert_sorted(temp);
-        temp=temp->next;
-    }
+    //hand the expensive tail over to out (no new nodes)
+    out.clear();
+    out.front=p;
+    out._size=_size-kept;
+    if(prev==nullptr)
+        front=nullptr;
+    else
+        prev->next=nullptr;
+    _size=kept;
+    drop_index();
+
+    return true;
+   }
+
+   /**
+   * func: best_time_within_budget
+   * precondition:  list must be sorted and pareto (if not, false is returned).
+   * desc: finds the fastest option with price <= budget.  In a pareto-sorted list that is the
+   *       most expensive option within budget.
+   * returns: true and the option in price/time if there is one; false otherwise
+   * RUNTIME:  O(log n) by binary search over the snapshot (see index())
+   * status:  DONE
+   */
+   bool best_time_within_budget(Price budget, Price &price, Time &time) const {
+       TRVL_STAT_OP(BEST_TIME_WITHIN_BUDGET);
+       if(!is_pareto_sorted())
+           return false;
+       const PriceIndex &idx = index();
+       size_t k = std::upper_bound(idx.price.begin(), idx.price.end(), budget) - idx.price.begin();
+
+       if(k == 0)
+           return false;
+       price = idx.price[k-1];
+       time = idx.time[k-1];
+       return true;
+   }
 
+   /**
+   * func: cheapest_within_time
+   * precondition:  list must be sorted and pareto (if not, false is returned).
+   * desc: finds the cheapest option with time <= max_time (times are decreasing, so it is the
+   *       first such option).
+   * returns: true and the option in price/time if there is one; false otherwise
+   * RUNTIME:  O(log n)
+   * status:  DONE
+   */
+   bool cheapest_within_time(Time max_time, Price &price, Time &time) const {
+       TRVL_STAT_OP(CHEAPEST_WITHIN_TIME);
+       if(!is_pareto_sorted())
+           return false;
+       const PriceIndex &idx = index();
+       size_t k = std::lower_bound(idx.time.begin(), idx.time.end(), max_time,
+                                   std::greater<Time>()) - idx.time.begin();
+
+       if(k == idx.time.size())
+           return false;
+       price = idx.price[k];
+       time = idx.time[k];
+       return true;
+   }
 
+   /**
+   * func: range
+   * precondition:  list must be sorted and pareto (if not, nullptr is returned).
+   * desc: the options with price_lo <= price <= price_hi, in list order.
+   * returns: a pointer to a new vector (as in to_vec)
+   * RUNTIME:  O(log n + k) for k options returned
+   * status:  DONE
+   */
+   std::vector<std::pair<Price, Time>> * range(Price price_lo, Price price_hi) const {
+       TRVL_STAT_OP(RANGE);
+       if(!is_pareto_sorted())
+           return nullptr;
+       const PriceIndex &idx = index();
+       size_t lo = std::lower_bound(idx.price.begin(), idx.price.end(), price_lo) - idx.price.begin();
+       size_t hi = std::upper_bound(idx.price.begin(), idx.price.end(), price_hi) - idx.price.begin();
+       std::vector<std::pair<Price, Time>> *vec = new std::vector<std::pair<Price, Time>>();
+
+       TRVL_STAT(NODES_VISITED, hi > lo ? hi - lo : 0);
+       for(size_t k = lo; k < hi; k++)
+           vec->push_back(std::pair<Price, Time>(idx.price[k], idx.time[k]));
+       return vec;
+   }
 
-        return tr;
+  private:
 
+   /**
+   * func: index
+   * desc: private; contiguous price/time snapshot of the list (in list order) behind the queries
+   *       above and the vectorized is_pareto scan.  Built by the first use (O(n)) and reused until
+   *       a mutator drops it (every operation that changes the list, e.g. insert_pareto_sorted,
+   *       marks it stale).
+   *
+   * COMMENT:  builds lazily from const queries, so two threads must not run the first query
+   *           on the same object at the same time.
+   * status:  DONE
+   */
+   const PriceIndex & index() const {
+       if(_index == nullptr) {
+           _index = new PriceIndex();
+           _index->valid = false;
+       }
+       if(!_index->valid) {
+           TRVL_STAT_OP(BUILD_INDEX);
+           TRVL_STAT(NODES_VISITED, _size);
+           Node *p = front;
+
+           _index->price.clear();
+           _index->time.clear();
+           while(p != nullptr) {
+               _index->price.push_back(p->price);
+               _index->time.push_back(p->time);
+               p = p->next;
+           }
+           _index->valid = true;
+       }
+       return *_index;
    }
 
+  public:
+
    /**
    * func: display
    * desc: prints a string representation of the current TravelOptions object
@@ -711,7 +2653,7 @@ class TravelOptions{
 	Node * p = front;
 	
 	while(p!=nullptr) {
-		printf("   %5.2f      %5.2f\n", p->price, p->time);
+		printf("   %5.2f      %5.2f\n", (double)p->price, (double)p->time);
 		p = p->next;
 	}
    }
@@ -739,4 +2681,8 @@ class TravelOptions{
 
 };
 
+typedef BasicTravelOptions<double, double> TravelOptions;
+typedef BasicTravelOptions<int32_t, int32_t> TravelOptions32;
+typedef BasicTravelOptions<float, float> TravelOptionsF;
+
 #endif
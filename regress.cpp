@@ -0,0 +1,1409 @@
+#include "TravelOptions.h"
+#include "FlatTravelOptions.h"
+#include "Skyline.h"
+#include "RoutePlanner.h"
+#include "LayeredTravelOptions.h"
+#include "ConcurrentTravelOptions.h"
+#include "FareIngest.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <random>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+/*
+ regression driver for TravelOptions and the helper classes.
+
+to compile:  g++ -std=c++11 -O1 -pthread -DTRVL_DEBUG_FLAGS -fsanitize=address,undefined regress.cpp
+to run:      ./a.out [seed]
+
+ purpose:  checks every operation against a brute-force reference (all pairs, or the full cross
+             product) on many small random inputs.  Prices and times come from a small range, so
+             ties, duplicates and dominated options are common; empty inputs, outputs aliased to
+             an input and int32 overflow are checked explicitly.  Prints each failed check; the
+             exit status is 0 iff every check passed.  With -DTRVL_DEBUG_FLAGS every cached
+             sorted / pareto flag is also cross-checked against a scan.  The concurrent tests
+             start threads; build with -fsanitize=thread (instead of address) to check them for
+             data races.  FareIngest parses with std::from_chars under -std=c++17 and with strtod
+             below it; build both ways to cover both parsers.  Build with -DTRVL_STATS too:  the
+             stats test then checks exact counter values.
+*/
+
+typedef std::pair<double, double> Opt;
+typedef std::vector<Opt> OptVec;
+typedef std::pair<int32_t, int32_t> Opt32;
+typedef std::vector<Opt32> OptVec32;
+
+static std::mt19937 gen;
+static long checks = 0, failures = 0;
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+static void check(bool ok, const char *what, int line) {
+  checks++;
+  if(!ok) {
+    failures++;
+    if(failures <= 20)
+      printf("FAIL (line %d):  %s\n", line, what);
+  }
+}
+
+static int rnd(int n) {
+  return (int)(gen() % n);
+}
+
+// n options with price and time in [0, range)
+template <typename P, typename T>
+static std::vector<std::pair<P, T>> random_options(int n, int range) {
+  std::vector<std::pair<P, T>> v;
+
+  for(int i=0; i<n; i++)
+    v.push_back(std::pair<P, T>((P)rnd(range), (T)rnd(range)));
+  return v;
+}
+
+static OptVec random_vec(int n, int range) {
+  return random_options<double, double>(n, range);
+}
+
+template <typename P, typename T>
+static std::vector<std::pair<P, T>> contents(const BasicTravelOptions<P, T> &list) {
+  std::vector<std::pair<P, T>> v;
+
+  list.to_vec(v);
+  return v;
+}
+
+/*
+ * the references
+ */
+
+// the frontier of v, sorted:  an option stays unless another one is better than or equal to it
+// (of several equal options, the first stays).  O(n^2).
+template <typename P, typename T>
+static std::vector<std::pair<P, T>> brute_pareto(const std::vector<std::pair<P, T>> &v) {
+  std::vector<std::pair<P, T>> out;
+
+  for(size_t i=0; i<v.size(); i++) {
+    bool keep = true;
+    for(size_t j=0; j<v.size() && keep; j++) {
+      bool covers = v[j].first <= v[i].first && v[j].second <= v[i].second;
+      if(j != i && covers && (v[j] != v[i] || j < i))
+        keep = false;
+    }
+    if(keep)
+      out.push_back(v[i]);
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+template <typename P, typename T>
+static bool brute_is_pareto_sorted(const std::vector<std::pair<P, T>> &v) {
+  for(size_t i=1; i<v.size(); i++) {
+    if(!(v[i-1].first < v[i].first && v[i-1].second > v[i].second))
+      return false;
+  }
+  return true;
+}
+
+template <typename P, typename T>
+static std::vector<std::pair<P, T>> concat(const std::vector<std::pair<P, T>> &a,
+                                           const std::vector<std::pair<P, T>> &b) {
+  std::vector<std::pair<P, T>> v(a);
+
+  v.insert(v.end(), b.begin(), b.end());
+  return v;
+}
+
+// every pairing <pa+pb, ta+tb>, then the frontier
+template <typename P, typename T>
+static std::vector<std::pair<P, T>> brute_join_plus_plus(const std::vector<std::pair<P, T>> &a,
+                                                         const std::vector<std::pair<P, T>> &b) {
+  std::vector<std::pair<P, T>> v;
+
+  for(size_t i=0; i<a.size(); i++) {
+    for(size_t j=0; j<b.size(); j++)
+      v.push_back(std::pair<P, T>(a[i].first + b[j].first, a[i].second + b[j].second));
+  }
+  return brute_pareto(v);
+}
+
+// every pairing <pa+pb, MAX(ta,tb)>, then the frontier
+static OptVec brute_join_plus_max(const OptVec &a, const OptVec &b) {
+  OptVec v;
+
+  for(size_t i=0; i<a.size(); i++) {
+    for(size_t j=0; j<b.size(); j++)
+      v.push_back(Opt(a[i].first + b[j].first, std::max(a[i].second, b[j].second)));
+  }
+  return brute_pareto(v);
+}
+
+/*
+ * the checks, one function per group of operations
+ */
+
+// compare, the is_* properties, from_vec / to_vec, pareto_from_vec, insert_sorted,
+// insert_pareto_sorted, union_pareto_sorted (both forms), prune_sorted, split_sorted_pareto
+static void test_basics() {
+  for(int it=0; it<400; it++) {
+    int range = 1 + rnd(20);
+    OptVec v = random_vec(rnd(30), range), sorted(v);
+    std::sort(sorted.begin(), sorted.end());
+
+    TravelOptions *a = TravelOptions::from_vec(v);
+    CHECK(contents(*a) == v);
+    CHECK(a->size() == (int)v.size());
+    CHECK(a->is_sorted() == std::is_sorted(v.begin(), v.end()));
+    CHECK(a->is_pareto() == (brute_pareto(v).size() == v.size()));
+    CHECK(a->is_pareto_sorted() == brute_is_pareto_sorted(v));
+
+    Opt x(rnd(range), rnd(range)), y(rnd(range), rnd(range));
+    TravelOptions::Relationship r = TravelOptions::compare(x.first, x.second, y.first, y.second);
+    if(x == y)
+      CHECK(r == TravelOptions::equal);
+    else if(x.first <= y.first && x.second <= y.second)
+      CHECK(r == TravelOptions::better);
+    else if(x.first >= y.first && x.second >= y.second)
+      CHECK(r == TravelOptions::worse);
+    else
+      CHECK(r == TravelOptions::incomparable);
+
+    // insert_sorted / prune_sorted:  false on an unsorted list
+    if(!std::is_sorted(v.begin(), v.end())) {
+      CHECK(!a->insert_sorted(x.first, x.second));
+      CHECK(!a->prune_sorted());
+      CHECK(contents(*a) == v);
+    }
+    TravelOptions *s = TravelOptions::from_vec(sorted);
+    OptVec plus = concat(sorted, OptVec(1, x));
+    std::sort(plus.begin(), plus.end());
+    CHECK(s->insert_sorted(x.first, x.second));
+    CHECK(contents(*s) == plus);
+    CHECK(s->prune_sorted());
+    CHECK(contents(*s) == brute_pareto(plus));
+
+    // pareto_from_vec / insert_pareto_sorted
+    TravelOptions *f = TravelOptions::pareto_from_vec(v);
+    OptVec fv = brute_pareto(v);
+    CHECK(contents(*f) == fv);
+    CHECK(f->insert_pareto_sorted(x.first, x.second));
+    fv = brute_pareto(concat(fv, OptVec(1, x)));
+    CHECK(contents(*f) == fv);
+    if(!a->is_pareto_sorted())
+      CHECK(!a->insert_pareto_sorted(x.first, x.second));
+
+    // union_pareto_sorted, into a new object and into out (fresh, or aliased to either input)
+    OptVec w = random_vec(rnd(30), range);
+    TravelOptions *g = TravelOptions::pareto_from_vec(w);
+    OptVec gv = brute_pareto(w), u = brute_pareto(concat(fv, gv));
+    TravelOptions *un = f->union_pareto_sorted(*g);
+    CHECK(un != nullptr && contents(*un) == u);
+    TravelOptions out, f2(*f), g2(*g);
+    CHECK(f->union_pareto_sorted(*g, out) && contents(out) == u);
+    CHECK(f2.union_pareto_sorted(*g, f2) && contents(f2) == u);
+    CHECK(f->union_pareto_sorted(g2, g2) && contents(g2) == u);
+    if(!a->is_pareto_sorted()) {
+      CHECK(a->union_pareto_sorted(*g) == nullptr);
+      CHECK(!g->union_pareto_sorted(*a, out) && contents(out) == u);
+    }
+
+    // split_sorted_pareto:  no node is created or lost, so the checksums add up (XOR)
+    double m = rnd(range + 2) - 1;
+    OptVec cheap, dear;
+    for(size_t i=0; i<fv.size(); i++)
+      (fv[i].first <= m ? cheap : dear).push_back(fv[i]);
+    TravelOptions f3(*f);
+    unsigned long sum = f3.checksum();
+    TravelOptions *exp = f3.split_sorted_pareto(m);
+    CHECK(exp != nullptr && contents(f3) == cheap && contents(*exp) == dear);
+    CHECK(exp != nullptr && (f3.checksum() ^ exp->checksum()) == sum);
+    TravelOptions f4(*f), rest;
+    CHECK(f4.split_sorted_pareto(m, rest) && contents(f4) == cheap && contents(rest) == dear);
+    CHECK(!f4.split_sorted_pareto(m, f4));
+    if(!a->is_pareto_sorted())
+      CHECK(a->split_sorted_pareto(m) == nullptr);
+
+    delete a; delete s; delete f; delete g; delete un; delete exp;
+  }
+}
+
+// join_plus_plus:  both forms, outputs aliased to an input, empty lists, int32
+static void test_join_plus_plus() {
+  for(int it=0; it<400; it++) {
+    int range = 1 + rnd(30);
+    OptVec va = random_vec(rnd(25), range), vb = random_vec(rnd(25), range);
+    OptVec ref = brute_join_plus_plus(va, vb);
+    TravelOptions *a = TravelOptions::from_vec(va), *b = TravelOptions::from_vec(vb);
+
+    TravelOptions *j = a->join_plus_plus(*b);
+    CHECK(j != nullptr && contents(*j) == ref);
+    CHECK(j != nullptr && j->is_pareto_sorted());
+
+    TravelOptions out, a2(*a), b2(*b);
+    out.push_front(1, 1);
+    CHECK(a->join_plus_plus(*b, out) && contents(out) == ref);
+    CHECK(a2.join_plus_plus(*b, a2) && contents(a2) == ref);
+    CHECK(a->join_plus_plus(b2, b2) && contents(b2) == ref);
+    TravelOptions self(*a);
+    CHECK(self.join_plus_plus(self, self) && contents(self) == brute_join_plus_plus(va, va));
+
+    OptVec32 ia = random_options<int32_t, int32_t>(rnd(25), range);
+    OptVec32 ib = random_options<int32_t, int32_t>(rnd(25), range);
+    TravelOptions32 *a32 = TravelOptions32::from_vec(ia), *b32 = TravelOptions32::from_vec(ib);
+    TravelOptions32 *j32 = a32->join_plus_plus(*b32);
+    CHECK(j32 != nullptr && contents(*j32) == brute_join_plus_plus(ia, ib));
+
+    delete a; delete b; delete j; delete a32; delete b32; delete j32;
+  }
+
+  // an empty list joins to an empty (not null) list
+  TravelOptions empty, one;
+  one.push_front(1, 2);
+  TravelOptions *j = one.join_plus_plus(empty);
+  CHECK(j != nullptr && j->size() == 0);
+  delete j;
+
+  // int32 overflow:  nullptr, or false with out unchanged
+  TravelOptions32 big, small, out;
+  big.push_front(INT32_MAX - 1, 5);
+  small.push_front(2, 5);
+  out.push_front(7, 7);
+  CHECK(big.join_plus_plus(small) == nullptr);
+  CHECK(!big.join_plus_plus(small, out) && contents(out) == OptVec32(1, Opt32(7, 7)));
+  TravelOptions32 slow, fast;
+  slow.push_front(1, INT32_MAX);
+  fast.push_front(1, 1);
+  CHECK(slow.join_plus_plus(fast) == nullptr);
+}
+
+// chain_plus_plus / chain_plus_max against folds of the brute joins
+static void test_chains() {
+  for(int it=0; it<200; it++) {
+    int range = 1 + rnd(15), k = rnd(5);
+    std::vector<TravelOptions *> lists;
+    std::vector<const TravelOptions *> legs, frontiers;
+    OptVec pp, pm;
+
+    for(int i=0; i<k; i++) {
+      OptVec v = random_vec(rnd(8), range);
+      TravelOptions *raw = TravelOptions::from_vec(v), *f = TravelOptions::pareto_from_vec(v);
+      lists.push_back(raw);
+      lists.push_back(f);
+      legs.push_back(raw);
+      frontiers.push_back(f);
+      pp = i == 0 ? brute_pareto(v) : brute_join_plus_plus(pp, v);
+      pm = i == 0 ? brute_pareto(v) : brute_join_plus_max(pm, brute_pareto(v));
+    }
+
+    TravelOptions *c = TravelOptions::chain_plus_plus(legs);
+    CHECK(c != nullptr && contents(*c) == pp);
+    TravelOptions *m = TravelOptions::chain_plus_max(frontiers);
+    CHECK(m != nullptr && contents(*m) == pm);
+    delete c;
+    delete m;
+
+    if(k > 0) {
+      legs.push_back(nullptr);
+      CHECK(TravelOptions::chain_plus_plus(legs) == nullptr);
+      if(!legs[0]->is_pareto_sorted()) {
+        frontiers[0] = legs[0];
+        CHECK(TravelOptions::chain_plus_max(frontiers) == nullptr);
+      }
+    }
+    for(size_t i=0; i<lists.size(); i++)
+      delete lists[i];
+  }
+}
+
+// union_pareto_sorted_k and its splice form
+static void test_union_k() {
+  for(int it=0; it<300; it++) {
+    int range = 1 + rnd(25), k = rnd(6);
+    std::vector<TravelOptions *> lists, copies;
+    std::vector<const TravelOptions *> in;
+    OptVec all;
+
+    for(int i=0; i<k; i++) {
+      OptVec v = random_vec(rnd(15), range);
+      all = concat(all, v);
+      lists.push_back(TravelOptions::pareto_from_vec(v));
+      copies.push_back(new TravelOptions(*lists.back()));
+      in.push_back(lists.back());
+    }
+    OptVec ref = brute_pareto(all);
+
+    TravelOptions *u = TravelOptions::union_pareto_sorted_k(in);
+    CHECK(u != nullptr && contents(*u) == ref);
+    TravelOptions *s = TravelOptions::splice_union_pareto_sorted_k(copies);
+    CHECK(s != nullptr && contents(*s) == ref);
+    for(int i=0; i<k; i++)
+      CHECK(copies[i]->size() == 0);
+
+    if(k > 0) {
+      std::vector<TravelOptions *> twice(copies);
+      twice.push_back(copies[0]);
+      CHECK(TravelOptions::splice_union_pareto_sorted_k(twice) == nullptr);
+    }
+    std::vector<const TravelOptions *> with_null(in);
+    with_null.push_back(nullptr);
+    CHECK(TravelOptions::union_pareto_sorted_k(with_null) == nullptr);
+    OptVec unsorted;
+    unsorted.push_back(Opt(2, 2));
+    unsorted.push_back(Opt(1, 3));
+    TravelOptions *bad = TravelOptions::from_vec(unsorted);
+    in.push_back(bad);
+    CHECK(TravelOptions::union_pareto_sorted_k(in) == nullptr);
+
+    delete u; delete s; delete bad;
+    for(int i=0; i<k; i++) {
+      delete lists[i];
+      delete copies[i];
+    }
+  }
+}
+
+// insert_pareto_sorted_batch
+static void test_batch() {
+  for(int it=0; it<400; it++) {
+    int range = 1 + rnd(25);
+    OptVec v = random_vec(rnd(30), range), batch = random_vec(rnd(30), range);
+    TravelOptions *f = TravelOptions::pareto_from_vec(v), *a = TravelOptions::from_vec(v);
+
+    CHECK(f->insert_pareto_sorted_batch(batch));
+    CHECK(contents(*f) == brute_pareto(concat(v, batch)));
+    if(!brute_is_pareto_sorted(v)) {
+      CHECK(!a->insert_pareto_sorted_batch(batch));
+      CHECK(contents(*a) == v);
+    }
+    delete f;
+    delete a;
+  }
+}
+
+// best_time_within_budget / cheapest_within_time / range, including after the list changes
+static void test_queries() {
+  for(int it=0; it<400; it++) {
+    int range = 1 + rnd(40);
+    OptVec v = random_vec(rnd(30), range);
+    TravelOptions *f = TravelOptions::pareto_from_vec(v);
+
+    for(int round=0; round<2; round++) {
+      OptVec fv = contents(*f);
+      for(int q=0; q<10; q++) {
+        double budget = rnd(range + 2) - 1, lo = rnd(range + 2) - 1, hi = rnd(range + 2) - 1;
+        double p = -1, t = -1, bp = -1, bt = -1;
+        bool found = false;
+
+        // fastest option within budget; cheapest option within budget as max_time
+        for(size_t i=0; i<v.size(); i++) {
+          if(v[i].first <= budget && (!found || v[i].second < bt || (v[i].second == bt && v[i].first < bp))) {
+            bp = v[i].first;
+            bt = v[i].second;
+            found = true;
+          }
+        }
+        CHECK(f->best_time_within_budget(budget, p, t) == found);
+        CHECK(!found || (p == bp && t == bt));
+
+        found = false;
+        for(size_t i=0; i<v.size(); i++) {
+          if(v[i].second <= budget && (!found || v[i].first < bp || (v[i].first == bp && v[i].second < bt))) {
+            bp = v[i].first;
+            bt = v[i].second;
+            found = true;
+          }
+        }
+        CHECK(f->cheapest_within_time(budget, p, t) == found);
+        CHECK(!found || (p == bp && t == bt));
+
+        OptVec in;
+        for(size_t i=0; i<fv.size(); i++) {
+          if(lo <= fv[i].first && fv[i].first <= hi)
+            in.push_back(fv[i]);
+        }
+        OptVec *r = f->range(lo, hi);
+        CHECK(r != nullptr && *r == in);
+        delete r;
+      }
+      // the cached snapshot must follow the list
+      Opt x(rnd(range), rnd(range));
+      f->insert_pareto_sorted(x.first, x.second);
+      v.push_back(x);
+    }
+
+    if(!brute_is_pareto_sorted(v)) {
+      TravelOptions *a = TravelOptions::from_vec(v);
+      double p, t;
+      CHECK(!a->best_time_within_budget(range, p, t));
+      CHECK(!a->cheapest_within_time(range, p, t));
+      CHECK(a->range(0, range) == nullptr);
+      delete a;
+    }
+    delete f;
+  }
+}
+
+// join_plus_max:  both forms, aliasing, preconditions, int32 overflow
+static void test_join_plus_max() {
+  for(int it=0; it<400; it++) {
+    int range = 1 + rnd(30);
+    OptVec va = random_vec(rnd(25), range), vb = random_vec(rnd(25), range);
+    OptVec ref = brute_join_plus_max(brute_pareto(va), brute_pareto(vb));
+    TravelOptions *a = TravelOptions::pareto_from_vec(va), *b = TravelOptions::pareto_from_vec(vb);
+
+    TravelOptions *j = a->join_plus_max(*b);
+    CHECK(j != nullptr && contents(*j) == ref);
+    TravelOptions out, a2(*a), b2(*b);
+    out.push_front(3, 3);
+    CHECK(a->join_plus_max(*b, out) && contents(out) == ref);
+    CHECK(a2.join_plus_max(*b, a2) && contents(a2) == ref);
+    CHECK(a->join_plus_max(b2, b2) && contents(b2) == ref);
+
+    if(!brute_is_pareto_sorted(va)) {
+      TravelOptions *raw = TravelOptions::from_vec(va);
+      CHECK(raw->join_plus_max(*b) == nullptr);
+      CHECK(!b->join_plus_max(*raw, out));
+      delete raw;
+    }
+    delete a; delete b; delete j;
+  }
+
+  TravelOptions32 big, small;
+  big.push_front(INT32_MAX, 1);
+  small.push_front(1, 1);
+  CHECK(big.join_plus_max(small) == nullptr);
+}
+
+// join_plus_plus_parallel:  legs large enough to use the threads
+static void test_parallel() {
+  for(int it=0; it<3; it++) {
+    OptVec va = random_vec(20000, 100000), vb = random_vec(1 + rnd(40), 100000);
+    TravelOptions *a = TravelOptions::from_vec(va), *b = TravelOptions::from_vec(vb);
+    TravelOptions *serial = a->join_plus_plus(*b);
+
+    // every pairing through pareto_from_vec (the O(n^2) reference is too slow at this size)
+    OptVec sums;
+    for(size_t i=0; i<va.size(); i++) {
+      for(size_t j=0; j<vb.size(); j++)
+        sums.push_back(Opt(va[i].first + vb[j].first, va[i].second + vb[j].second));
+    }
+    TravelOptions *ref = TravelOptions::pareto_from_vec(sums);
+    CHECK(contents(*serial) == contents(*ref));
+
+    for(unsigned n=2; n<=4; n++) {
+      TravelOptions *par = a->join_plus_plus_parallel(*b, n);
+      CHECK(par != nullptr && contents(*par) == contents(*serial));
+      delete par;
+    }
+    TravelOptions empty;
+    TravelOptions *none = a->join_plus_plus_parallel(empty, 4);
+    CHECK(none != nullptr && none->size() == 0);
+    delete a; delete b; delete serial; delete ref; delete none;
+  }
+
+  // int32:  overflow is decided on the global frontier, as in the serial join.  Half of leg a is a huge
+  // option that <0,0> dominates; the chunks holding only huge options keep it on their local frontier,
+  // and that must not fail the join.
+  for(int huge_first=0; huge_first<2; huge_first++) {
+    OptVec32 va(10000, Opt32(0, 0)), vb(1, Opt32(10, 10));
+    va.insert(huge_first ? va.begin() : va.end(), 10000, Opt32(INT32_MAX - 1, 5));
+    TravelOptions32 *a = TravelOptions32::from_vec(va), *b = TravelOptions32::from_vec(vb);
+    TravelOptions32 *serial = a->join_plus_plus(*b);
+    CHECK(serial != nullptr && contents(*serial) == OptVec32(1, Opt32(10, 10)));
+    for(unsigned n=2; n<=4; n++) {
+      TravelOptions32 *par = a->join_plus_plus_parallel(*b, n);
+      CHECK(par != nullptr && contents(*par) == OptVec32(1, Opt32(10, 10)));
+      delete par;
+    }
+
+    // a real overflow on the global frontier fails both ways
+    va[huge_first ? 0 : va.size() - 1] = Opt32(INT32_MAX - 1, -5);
+    TravelOptions32 *c = TravelOptions32::from_vec(va);
+    CHECK(c->join_plus_plus(*b) == nullptr);
+    for(unsigned n=2; n<=4; n++)
+      CHECK(c->join_plus_plus_parallel(*b, n) == nullptr);
+
+    // and random int32 legs agree with the serial join
+    OptVec32 ra = random_options<int32_t, int32_t>(20000, 100000), rb = random_options<int32_t, int32_t>(20, 100000);
+    TravelOptions32 *x = TravelOptions32::from_vec(ra), *y = TravelOptions32::from_vec(rb);
+    TravelOptions32 *xs = x->join_plus_plus(*y), *xp = x->join_plus_plus_parallel(*y, 3);
+    CHECK(xs != nullptr && xp != nullptr && contents(*xs) == contents(*xp));
+    delete a; delete b; delete c; delete serial; delete x; delete y; delete xs; delete xp;
+  }
+}
+
+// SkylineOptions<3, int>:  prune, is_pareto, union_pareto and the joins
+typedef SkylineOptions<3, int> Sky;
+
+static std::vector<Sky::Option> brute_skyline(const std::vector<Sky::Option> &v) {
+  std::vector<Sky::Option> out;
+
+  for(size_t i=0; i<v.size(); i++) {
+    bool keep = true;
+    for(size_t j=0; j<v.size() && keep; j++) {
+      bool covers = v[j][0] <= v[i][0] && v[j][1] <= v[i][1] && v[j][2] <= v[i][2];
+      if(j != i && covers && (v[j] != v[i] || j < i))
+        keep = false;
+    }
+    if(keep)
+      out.push_back(v[i]);
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+static std::vector<Sky::Option> random_sky(int n, int range) {
+  std::vector<Sky::Option> v(n);
+
+  for(int i=0; i<n; i++) {
+    for(int k=0; k<3; k++)
+      v[i][k] = rnd(range);
+  }
+  return v;
+}
+
+static void test_skyline() {
+  for(int it=0; it<300; it++) {
+    int range = 1 + rnd(8);
+    std::vector<Sky::Option> va = random_sky(rnd(25), range), vb = random_sky(rnd(25), range);
+    Sky *a = Sky::from_vec(va), *b = Sky::from_vec(vb);
+
+    CHECK(a->is_pareto() == (brute_skyline(va).size() == va.size()));
+    Sky *u = a->union_pareto(*b);
+    std::vector<Sky::Option> *uv = u->to_vec();
+    std::vector<Sky::Option> both(va);
+    both.insert(both.end(), vb.begin(), vb.end());
+    CHECK(*uv == brute_skyline(both));
+
+    Sky::Combiners how = { { Sky::SUM, Sky::MAX, Sky::MIN } };
+    std::vector<Sky::Option> pp, mixed;
+    for(size_t i=0; i<va.size(); i++) {
+      for(size_t j=0; j<vb.size(); j++) {
+        Sky::Option s = { { va[i][0] + vb[j][0], va[i][1] + vb[j][1], va[i][2] + vb[j][2] } };
+        Sky::Option m = { { va[i][0] + vb[j][0], std::max(va[i][1], vb[j][1]), std::min(va[i][2], vb[j][2]) } };
+        pp.push_back(s);
+        mixed.push_back(m);
+      }
+    }
+    Sky *j = a->join_plus_plus(*b), *k = a->join(*b, how);
+    std::vector<Sky::Option> *jv = j->to_vec(), *kv = k->to_vec();
+    CHECK(*jv == brute_skyline(pp));
+    CHECK(*kv == brute_skyline(mixed));
+
+    CHECK(a->prune());
+    std::vector<Sky::Option> *av = a->to_vec();
+    CHECK(*av == brute_skyline(va));
+    CHECK(a->is_pareto_sorted());
+
+    delete a; delete b; delete u; delete uv; delete j; delete k; delete jv; delete kv; delete av;
+  }
+}
+
+// prune_epsilon / join_plus_plus_epsilon:  the (1+eps) cover guarantee
+static bool covered_within(const OptVec &kept, const Opt &x, double eps_price, double eps_time) {
+  for(size_t i=0; i<kept.size(); i++) {
+    if(kept[i].first <= x.first * (1 + eps_price) * (1 + 1e-12) &&
+       kept[i].second <= x.second * (1 + eps_time) * (1 + 1e-12))
+      return true;
+  }
+  return false;
+}
+
+static void test_epsilon() {
+  const double eps[] = { 0, 0.01, 0.1, 0.5 };
+
+  for(int it=0; it<300; it++) {
+    double ep = eps[rnd(4)], et = eps[rnd(4)], err_price, err_time;
+    OptVec va = random_vec(rnd(40), 1000), vb = random_vec(rnd(20), 1000);
+    OptVec fv = brute_pareto(va);
+
+    TravelOptions f;
+    TravelOptions::from_vec(fv, f);
+    CHECK(f.prune_epsilon(ep, et, err_price, err_time));
+    OptVec kept = contents(f);
+    CHECK(brute_is_pareto_sorted(kept));
+    // the reported errors are ratios computed in double, so they may round a hair above eps
+    CHECK(err_price <= ep + 1e-12 && err_time <= et + 1e-12);
+    for(size_t i=0; i<kept.size(); i++)
+      CHECK(std::binary_search(fv.begin(), fv.end(), kept[i]));
+    for(size_t i=0; i<fv.size(); i++)
+      CHECK(covered_within(kept, fv[i], ep, et));
+
+    TravelOptions *a = TravelOptions::from_vec(va), *b = TravelOptions::from_vec(vb);
+    TravelOptions *j = a->join_plus_plus_epsilon(*b, ep, et);
+    OptVec exact = brute_join_plus_plus(va, vb), all;
+    for(size_t i=0; i<va.size(); i++) {
+      for(size_t k=0; k<vb.size(); k++)
+        all.push_back(Opt(va[i].first + vb[k].first, va[i].second + vb[k].second));
+    }
+    std::sort(all.begin(), all.end());
+    CHECK(j != nullptr);
+    if(j != nullptr) {
+      OptVec jv = contents(*j);
+      CHECK(brute_is_pareto_sorted(jv));
+      for(size_t i=0; i<jv.size(); i++)
+        CHECK(std::binary_search(all.begin(), all.end(), jv[i]));
+      for(size_t i=0; i<exact.size(); i++)
+        CHECK(covered_within(jv, exact[i], ep, et));
+    }
+    delete a; delete b; delete j;
+  }
+
+  TravelOptions neg, pos;
+  neg.push_front(-1, 2);
+  pos.push_front(1, 2);
+  CHECK(neg.join_plus_plus_epsilon(pos, 0.1, 0.1) == nullptr);
+  CHECK(!neg.prune_epsilon(0.1, 0.1));
+  CHECK(!pos.prune_epsilon(-0.1, 0.1));
+}
+
+// RoutePlanner:  every city's frontier against label-correcting relaxation to a fixpoint, and the
+// itineraries against the legs they were built from
+static void test_planner() {
+  for(int it=0; it<200; it++) {
+    int cities = 2 + rnd(6), nlegs = rnd(14), source = rnd(cities), range = 1 + rnd(10);
+    RoutePlanner rp(cities);
+    std::vector<int> from, to;
+    std::vector<OptVec> fares;
+
+    for(int l=0; l<nlegs; l++) {
+      int u = rnd(cities), w = rnd(cities);
+      OptVec f = random_vec(1 + rnd(3), range);
+      TravelOptions *fo = TravelOptions::from_vec(f);
+      CHECK(rp.add_leg(u, w, *fo));
+      delete fo;
+      from.push_back(u);
+      to.push_back(w);
+      fares.push_back(f);
+    }
+    CHECK(!rp.add_leg(0, cities, 1, 1));
+    CHECK(!rp.add_leg(0, 0, -1, 1));
+
+    std::vector<OptVec> labels(cities);
+    labels[source].push_back(Opt(0, 0));
+    for(bool changed = true; changed; ) {
+      changed = false;
+      for(int l=0; l<nlegs; l++) {
+        OptVec next = concat(labels[to[l]], brute_join_plus_plus(labels[from[l]], fares[l]));
+        next = brute_pareto(next);
+        if(next != labels[to[l]]) {
+          labels[to[l]] = next;
+          changed = true;
+        }
+      }
+    }
+
+    CHECK(rp.plan(source));
+    for(int c=0; c<cities; c++) {
+      OptVec fv = contents(rp.frontier(c));
+      CHECK(fv == labels[c]);
+
+      for(int k=0; k<(int)fv.size(); k++) {
+        std::vector<RoutePlanner::Leg> legs;
+        CHECK(rp.itinerary(c, k, legs));
+        double p = 0, t = 0;
+        int at = source;
+        for(size_t i=0; i<legs.size(); i++) {
+          bool exists = false;
+          for(int l=0; l<nlegs && !exists; l++) {
+            exists = from[l] == legs[i].from && to[l] == legs[i].to &&
+                     std::find(fares[l].begin(), fares[l].end(), Opt(legs[i].price, legs[i].time)) != fares[l].end();
+          }
+          CHECK(exists);
+          CHECK(legs[i].from == at);
+          at = legs[i].to;
+          p += legs[i].price;
+          t += legs[i].time;
+        }
+        CHECK(at == c && p == fv[k].first && t == fv[k].second);
+      }
+      std::vector<RoutePlanner::Leg> none;
+      CHECK(!rp.itinerary(c, (int)fv.size(), none));
+    }
+
+    int target = rnd(cities);
+    CHECK(rp.plan(source, target));
+    CHECK(contents(rp.frontier(target)) == labels[target]);
+  }
+}
+
+// join_plus_plus_view:  taken in pieces, with and without a cap, preconditions, int32 overflow
+static void test_join_view() {
+  for(int it=0; it<400; it++) {
+    int range = 1 + rnd(30);
+    OptVec va = random_vec(rnd(25), range), vb = random_vec(rnd(25), range);
+    OptVec ref = brute_join_plus_plus(va, vb);
+    TravelOptions *a = TravelOptions::pareto_from_vec(va), *b = TravelOptions::pareto_from_vec(vb);
+
+    TravelOptions::JoinView *v = a->join_plus_plus_view(*b);
+    OptVec got;
+    CHECK(v != nullptr);
+    if(v != nullptr) {
+      while(v->take(1 + rnd(4), got) > 0)
+        ;
+      CHECK(got == ref);
+      CHECK(v->count() == ref.size());
+      double p, t;
+      CHECK(!v->next(p, t));
+      delete v;
+    }
+
+    double cap = rnd(2 * range + 2) - 1;
+    OptVec capped;
+    for(size_t i=0; i<ref.size() && ref[i].first <= cap; i++)
+      capped.push_back(ref[i]);
+    v = b->join_plus_plus_view(*a, cap);
+    got.clear();
+    CHECK(v != nullptr && v->take(ref.size() + 1, got) == capped.size() && got == capped);
+    delete v;
+
+    if(!brute_is_pareto_sorted(va)) {
+      TravelOptions *raw = TravelOptions::from_vec(va);
+      CHECK(raw->join_plus_plus_view(*b) == nullptr);
+      CHECK(b->join_plus_plus_view(*raw, cap) == nullptr);
+      delete raw;
+    }
+    delete a; delete b;
+  }
+
+  TravelOptions32 big, small;
+  big.push_front(INT32_MAX, 1);
+  small.push_front(1, 1);
+  CHECK(big.join_plus_plus_view(small) == nullptr);
+}
+
+// LayeredTravelOptions:  random inserts and erases against peeling the multiset from scratch
+static std::vector<OptVec> brute_layers(OptVec v) {
+  std::vector<OptVec> layers;
+
+  while(!v.empty()) {
+    OptVec front = brute_pareto(v), rest;
+    // brute_pareto keeps one copy of a duplicate; the others stay for the next layer
+    OptVec left(front);
+    for(size_t i=0; i<v.size(); i++) {
+      OptVec::iterator f = std::find(left.begin(), left.end(), v[i]);
+      if(f != left.end())
+        left.erase(f);
+      else
+        rest.push_back(v[i]);
+    }
+    layers.push_back(front);
+    v = rest;
+  }
+  return layers;
+}
+
+static void test_layered() {
+  for(int it=0; it<200; it++) {
+    int range = 1 + rnd(15);
+    LayeredTravelOptions l;
+    OptVec all;
+
+    if(rnd(3) == 0) {
+      all = random_vec(rnd(40), range);
+      l.assign(all);
+    }
+    for(int step=0; step<60; step++) {
+      Opt x(rnd(range), rnd(range));
+      if(rnd(2) == 0 || all.empty()) {
+        l.insert(x.first, x.second);
+        all.push_back(x);
+      }
+      else {
+        if(rnd(2) == 0)
+          x = all[rnd((int)all.size())];
+        OptVec::iterator f = std::find(all.begin(), all.end(), x);
+        CHECK(l.erase(x.first, x.second) == (f != all.end()));
+        if(f != all.end())
+          all.erase(f);
+      }
+
+      std::vector<OptVec> ref = brute_layers(all);
+      CHECK(l.is_valid());
+      CHECK(l.size() == all.size() && l.layers() == ref.size());
+      for(size_t k=0; k<ref.size() && k<l.layers(); k++)
+        CHECK(l.layer(k) == ref[k]);
+
+      Opt q(rnd(range), rnd(range));
+      CHECK(l.contains(q.first, q.second) == (std::find(all.begin(), all.end(), q) != all.end()));
+      TravelOptions f;
+      l.frontier(f);
+      CHECK(contents(f) == (ref.empty() ? OptVec() : ref[0]));
+    }
+  }
+}
+
+// sort_in_place / sort_and_prune_in_place / sorted_clone
+static void test_sort() {
+  for(int it=0; it<400; it++) {
+    OptVec v = random_vec(rnd(300), 1 + rnd(40)), sorted(v);
+    std::stable_sort(sorted.begin(), sorted.end());
+    TravelOptions *a = TravelOptions::from_vec(v), *b = TravelOptions::from_vec(v);
+
+    // what is already known about the list must survive (or be dropped) correctly
+    if(rnd(2) == 0) {
+      a->is_pareto();
+      b->is_pareto();
+    }
+    unsigned long sum = a->checksum();
+    TravelOptions *c = a->sorted_clone();
+    TravelOptions d;
+    a->sorted_clone(d);
+    a->sort_in_place();
+    CHECK(contents(*a) == sorted && a->checksum() == sum && a->is_sorted());
+    CHECK(a->is_pareto() == (brute_pareto(v).size() == v.size()));
+    CHECK(contents(*c) == sorted && contents(d) == sorted);
+
+    b->sort_and_prune_in_place();
+    CHECK(contents(*b) == brute_pareto(v) && b->is_pareto_sorted());
+    a->sort_and_prune_in_place();
+    CHECK(contents(*a) == brute_pareto(v));
+
+    delete a; delete b; delete c;
+  }
+}
+
+// FlatTravelOptions against TravelOptions on the same inputs:  from_vec, the is_* properties,
+// join_plus_plus, join_plus_max, union_pareto_sorted, prune_sorted, insert_pareto_sorted, split
+static OptVec flat_contents(const FlatTravelOptions &list) {
+  OptVec *v = list.to_vec();
+  OptVec r(*v);
+
+  delete v;
+  return r;
+}
+
+static void test_flat() {
+  for(int it=0; it<400; it++) {
+    int range = 1 + rnd(30);
+    OptVec va = random_vec(rnd(30), range), vb = random_vec(rnd(30), range), sorted(va);
+    std::sort(sorted.begin(), sorted.end());
+    TravelOptions *a = TravelOptions::from_vec(va), *b = TravelOptions::from_vec(vb);
+    FlatTravelOptions *fa = FlatTravelOptions::from_vec(va), *fb = FlatTravelOptions::from_vec(vb);
+
+    CHECK(flat_contents(*fa) == va && fa->size() == (int)va.size());
+    CHECK(fa->is_sorted() == a->is_sorted());
+    CHECK(fa->is_pareto() == a->is_pareto());
+    CHECK(fa->is_pareto_sorted() == a->is_pareto_sorted());
+
+    TravelOptions *j = a->join_plus_plus(*b);
+    FlatTravelOptions *fj = fa->join_plus_plus(*fb);
+    CHECK(flat_contents(*fj) == contents(*j));
+    CHECK(flat_contents(*fj) == brute_join_plus_plus(va, vb));
+
+    // the operations on sorted-pareto lists, on the frontiers of both inputs
+    TravelOptions *pa = TravelOptions::pareto_from_vec(va), *pb = TravelOptions::pareto_from_vec(vb);
+    OptVec fva = contents(*pa), fvb = contents(*pb);
+    FlatTravelOptions *qa = FlatTravelOptions::from_vec(fva), *qb = FlatTravelOptions::from_vec(fvb);
+    TravelOptions *u = pa->union_pareto_sorted(*pb), *m = pa->join_plus_max(*pb);
+    FlatTravelOptions *fu = qa->union_pareto_sorted(*qb), *fm = qa->join_plus_max(*qb);
+    CHECK(u != nullptr && fu != nullptr && flat_contents(*fu) == contents(*u));
+    CHECK(m != nullptr && fm != nullptr && flat_contents(*fm) == contents(*m));
+    if(!a->is_pareto_sorted()) {
+      CHECK(fa->union_pareto_sorted(*qb) == nullptr);
+      CHECK(fa->join_plus_max(*qb) == nullptr);
+    }
+
+    // prune_sorted:  false on an unsorted list, else the same frontier
+    CHECK(fa->prune_sorted() == a->prune_sorted());
+    CHECK(flat_contents(*fa) == contents(*a));
+    FlatTravelOptions *fs = FlatTravelOptions::from_vec(sorted);
+    TravelOptions *s = TravelOptions::from_vec(sorted);
+    CHECK(fs->prune_sorted() && s->prune_sorted());
+    CHECK(flat_contents(*fs) == contents(*s) && flat_contents(*fs) == fva);
+
+    Opt x(rnd(range), rnd(range));
+    CHECK(qa->insert_pareto_sorted(x.first, x.second) && pa->insert_pareto_sorted(x.first, x.second));
+    CHECK(flat_contents(*qa) == contents(*pa));
+    double cut = rnd(range + 2) - 1;
+    FlatTravelOptions *fe = qa->split_sorted_pareto(cut);
+    TravelOptions *e = pa->split_sorted_pareto(cut);
+    CHECK(fe != nullptr && e != nullptr && flat_contents(*fe) == contents(*e));
+    CHECK(flat_contents(*qa) == contents(*pa));
+
+    delete a; delete b; delete fa; delete fb; delete j; delete fj; delete pa; delete pb; delete qa; delete qb;
+    delete u; delete m; delete fu; delete fm; delete fs; delete s; delete fe; delete e;
+  }
+}
+
+// compare_many (the vector kernels of Dominance.h, or the scalar ones with -DDOMINANCE_SCALAR) against
+// compare, element by element, and is_pareto on lists long enough for its sorting path
+static double special_value(int range) {
+  static const double nan = std::numeric_limits<double>::quiet_NaN();
+  static const double inf = std::numeric_limits<double>::infinity();
+  int r = rnd(20);
+
+  return r == 0 ? nan : r == 1 ? inf : r == 2 ? -0.0 : rnd(range);
+}
+
+// the pairwise definition:  no option is better than or equal to another (a NaN covers nothing)
+static bool brute_is_pareto(const OptVec &v) {
+  for(size_t i=0; i<v.size(); i++) {
+    for(size_t j=0; j<v.size(); j++) {
+      if(j != i && v[j].first <= v[i].first && v[j].second <= v[i].second)
+        return false;
+    }
+  }
+  return true;
+}
+
+static void test_dominance() {
+  for(int it=0; it<300; it++) {
+    int n = rnd(200), range = 1 + rnd(6);
+    std::vector<double> prices(n), times(n);
+    std::vector<TravelOptions::Relationship> out(n);
+    double pa = special_value(range), ta = special_value(range);
+
+    for(int j=0; j<n; j++) {
+      prices[j] = special_value(range);
+      times[j] = special_value(range);
+    }
+    TravelOptions::compare_many(pa, ta, prices.data(), times.data(), n, out.data());
+    bool same = true;
+    for(int j=0; j<n; j++)
+      same = same && out[j] == TravelOptions::compare(pa, ta, prices[j], times[j]);
+    CHECK(same);
+
+    std::vector<int32_t> ip(n), itm(n);
+    std::vector<TravelOptions32::Relationship> iout(n);
+    for(int j=0; j<n; j++) {
+      ip[j] = rnd(range);
+      itm[j] = rnd(range);
+    }
+    TravelOptions32::compare_many(1, 1, ip.data(), itm.data(), n, iout.data());
+    same = true;
+    for(int j=0; j<n; j++)
+      same = same && iout[j] == TravelOptions32::compare(1, 1, ip[j], itm[j]);
+    CHECK(same);
+
+    size_t covering = 0, limit = rnd(5);
+    for(int j=0; j<n && covering<limit; j++)
+      covering += prices[j] <= pa && times[j] <= ta;
+    CHECK(dominance::count_covering(pa, ta, prices.data(), times.data(), n, limit) == covering);
+  }
+
+  // is_pareto above 256 options:  a frontier (shuffled), then with a duplicate, a dominated option or a NaN
+  for(int it=0; it<40; it++) {
+    int n = 257 + rnd(1200);
+    OptVec v;
+    for(int i=0; i<n; i++)
+      v.push_back(Opt(i * 2 + rnd(2), 3 * n - 2 * i - rnd(2)));
+    std::shuffle(v.begin(), v.end(), gen);
+
+    int change = rnd(4);
+    if(change == 1)
+      v[rnd(n)] = v[rnd(n)];
+    else if(change == 2)
+      v[rnd(n)].second += 5;
+    else if(change == 3)
+      (rnd(2) ? v[rnd(n)].first : v[rnd(n)].second) = std::numeric_limits<double>::quiet_NaN();
+    TravelOptions *a = TravelOptions::from_vec(v);
+    CHECK(a->is_pareto() == brute_is_pareto(v));
+    delete a;
+  }
+}
+
+// ConcurrentTravelOptions:  writer threads (insert_pareto_sorted, prune_sorted, update) race reader threads
+// holding ReadGuards.  Readers check that versions only go up and that every snapshot is pareto-sorted
+// with flags matching its contents; the final frontier must equal a serial replay of all the writes.
+struct WriteOp {
+  int kind;        // 0 insert_pareto_sorted, 1 prune_sorted, 2 update with a batch insert
+  OptVec opts;
+};
+
+static bool replay(TravelOptions &m, const WriteOp &op) {
+  if(op.kind == 0)
+    return m.insert_pareto_sorted(op.opts[0].first, op.opts[0].second);
+  if(op.kind == 1)
+    return m.prune_sorted();
+  return m.insert_pareto_sorted_batch(op.opts);
+}
+
+static void test_concurrent() {
+  const int writers = 3, readers = 3, ops = 300;
+
+  for(int it=0; it<4; it++) {
+    ConcurrentTravelOptions c;
+    std::vector<std::vector<WriteOp>> plan(writers);
+    for(int w=0; w<writers; w++) {
+      for(int k=0; k<ops; k++) {
+        WriteOp op;
+        int r = rnd(10);
+        op.kind = r < 7 ? 0 : r < 8 ? 1 : 2;
+        op.opts = random_vec(op.kind == 0 ? 1 : op.kind == 2 ? 1 + rnd(8) : 0, 200);
+        plan[w].push_back(op);
+      }
+    }
+
+    std::atomic<int> running(writers);
+    std::vector<char> writes_ok(writers, 1), reads_ok(readers, 1);
+    std::vector<long> reads(readers, 0);
+    std::vector<std::thread> threads;
+    for(int w=0; w<writers; w++) {
+      threads.push_back(std::thread([&, w]() {
+        for(size_t k=0; k<plan[w].size(); k++) {
+          const WriteOp &op = plan[w][k];
+          bool ok = op.kind == 0 ? c.insert_pareto_sorted(op.opts[0].first, op.opts[0].second)
+                  : op.kind == 1 ? c.prune_sorted()
+                  : c.update([&op](TravelOptions &m) { return m.insert_pareto_sorted_batch(op.opts); });
+          if(!ok)
+            writes_ok[w] = 0;
+        }
+        running--;
+      }));
+    }
+    for(int r=0; r<readers; r++) {
+      threads.push_back(std::thread([&, r]() {
+        uint64_t last = 0;
+        do {
+          ConcurrentTravelOptions::ReadGuard g(c);
+          MappedOptions v = g.view();
+          OptVec *opts = v.to_vec();
+          bool pareto_sorted = brute_is_pareto_sorted(*opts);
+          if(g.snapshot().version() < last || !pareto_sorted || !v.is_pareto_sorted() ||
+             v.is_sorted() != std::is_sorted(opts->begin(), opts->end()) ||
+             v.is_pareto() != (brute_pareto(*opts).size() == opts->size()))
+            reads_ok[r] = 0;
+          last = g.snapshot().version();
+          delete opts;
+          reads[r]++;
+        } while(running > 0);
+      }));
+    }
+    for(size_t t=0; t<threads.size(); t++)
+      threads[t].join();
+
+    TravelOptions serial;
+    bool ok = true;
+    for(int w=0; w<writers; w++) {
+      for(size_t k=0; k<plan[w].size(); k++)
+        ok = replay(serial, plan[w][k]) && ok;
+    }
+    OptVec *final = c.to_vec();
+    CHECK(ok);
+    CHECK(*final == contents(serial));
+    CHECK(c.size() == serial.size());
+    delete final;
+    for(int w=0; w<writers; w++)
+      CHECK(writes_ok[w]);
+    for(int r=0; r<readers; r++)
+      CHECK(reads_ok[r] && reads[r] > 0);
+    // one version per publish:  never more than one per write
+    CHECK(c.version() >= 1 && c.version() <= (uint64_t)(writers * ops));
+  }
+}
+
+// FrontierFile:  several routes round-trip with their options and flags (and through from_mapped), a missing
+// key is not found, and truncated, corrupted or foreign files are rejected by open
+static std::vector<char> read_file(const std::string &path) {
+  std::ifstream in(path.c_str(), std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void write_file(const std::string &path, const std::vector<char> &bytes) {
+  std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+  out.write(bytes.data(), bytes.size());
+}
+
+static void test_frontier_file() {
+  char dir[] = "/tmp/regressXXXXXX";
+  if(mkdtemp(dir) == nullptr) {
+    CHECK(!"mkdtemp");
+    return;
+  }
+  std::string path = std::string(dir) + "/routes.bin", bad = std::string(dir) + "/bad.bin";
+
+  for(int it=0; it<60; it++) {
+    int k = rnd(7);
+    std::vector<TravelOptions *> lists;
+    std::vector<std::pair<std::string, const TravelOptions *>> routes;
+    for(int i=0; i<k; i++) {
+      OptVec v = random_vec(rnd(4) == 0 ? 0 : rnd(40), 1 + rnd(50));
+      lists.push_back(rnd(2) ? TravelOptions::pareto_from_vec(v) : TravelOptions::from_vec(v));
+      std::string key = i == 0 && rnd(2) ? std::string() : "route-" + std::to_string(i * 7 + rnd(7));
+      routes.push_back(std::make_pair(key, lists.back()));
+    }
+    CHECK(TravelOptions::save_binary(path.c_str(), routes));
+
+    FrontierFile *f = TravelOptions::load_mapped(path.c_str());
+    CHECK(f != nullptr);
+    if(f == nullptr)
+      continue;
+    CHECK(f->count() == k);
+    for(int i=0; i<k; i++) {
+      MappedOptions m;
+      const TravelOptions &l = *routes[i].second;
+      CHECK(f->find(routes[i].first, m));
+      OptVec *got = m.to_vec();
+      CHECK(*got == contents(l));
+      CHECK(m.is_sorted() == l.is_sorted() && m.is_pareto() == l.is_pareto() &&
+            m.is_pareto_sorted() == l.is_pareto_sorted());
+      TravelOptions *back = TravelOptions::from_mapped(m);
+      CHECK(contents(*back) == contents(l));
+      CHECK(back->is_sorted() == l.is_sorted() && back->is_pareto() == l.is_pareto() &&
+            back->is_pareto_sorted() == l.is_pareto_sorted());
+      TravelOptions32 *back32 = TravelOptions32::from_mapped(m);
+      CHECK(back32->size() == l.size() && back32->is_sorted() == l.is_sorted());
+      delete got; delete back; delete back32;
+    }
+    MappedOptions none;
+    CHECK(!f->find("no-such-route", none));
+    delete f;
+
+    // a repeated key is refused
+    if(k > 0) {
+      routes.push_back(routes[0]);
+      CHECK(!TravelOptions::save_binary(path.c_str(), routes));
+    }
+
+    // every damaged copy must fail to open
+    std::vector<char> bytes = read_file(path), copy;
+    copy.assign(bytes.begin(), bytes.end() - 8);
+    write_file(bad, copy);
+    CHECK(FrontierFile::open(bad.c_str()) == nullptr);
+    copy.assign(bytes.begin(), bytes.begin() + bytes.size() / 2);
+    write_file(bad, copy);
+    CHECK(FrontierFile::open(bad.c_str()) == nullptr);
+    copy = bytes;
+    copy.push_back(0);
+    write_file(bad, copy);
+    CHECK(FrontierFile::open(bad.c_str()) == nullptr);
+    if(bytes.size() > 64) {
+      copy = bytes;
+      copy[64 + rnd((int)bytes.size() - 64)] ^= (char)(1 << rnd(8));
+      write_file(bad, copy);
+      CHECK(FrontierFile::open(bad.c_str()) == nullptr);
+    }
+    copy = bytes;
+    copy[rnd(7)] ^= 0x20;
+    write_file(bad, copy);
+    CHECK(FrontierFile::open(bad.c_str()) == nullptr);
+
+    for(size_t i=0; i<lists.size(); i++)
+      delete lists[i];
+  }
+
+  // an empty frontier (the one-list form, under the empty key)
+  TravelOptions empty;
+  CHECK(empty.save_binary(path.c_str()));
+  FrontierFile *f = FrontierFile::open(path.c_str());
+  MappedOptions m;
+  CHECK(f != nullptr && f->count() == 1 && f->find("", m) && m.size() == 0 && m.is_pareto_sorted());
+  if(f != nullptr) {
+    TravelOptions *back = TravelOptions::from_mapped(m);
+    CHECK(back->size() == 0 && back->is_pareto_sorted());
+    delete back;
+  }
+  delete f;
+  CHECK(FrontierFile::open((std::string(dir) + "/missing.bin").c_str()) == nullptr);
+
+  remove(path.c_str());
+  remove(bad.c_str());
+  rmdir(dir);
+}
+
+// FareIngest:  one random feed (headers, malformed and blank lines, CRLF, padding, a line longer than a
+// chunk, no final '\n') read in 64-byte chunks, in default chunks and from memory; every route's frontier
+// must match the brute-force frontier of its records, and the counters must match the feed
+static void test_fare_ingest() {
+  static const char *bad[] = { "origin,dest,price,time", "A,B,x,5", "A,B,5", "A,B,5,6,7", "A,B,+-5,3",
+                               "A,B,nan,3", "A,B,,3", "A,B,5,", "A,B,5,3x", "A,B,++5,3", "A,B, + 5,3" };
+  const int nbad = sizeof(bad) / sizeof(bad[0]);
+
+  for(int it=0; it<100; it++) {
+    std::map<std::string, OptVec> expect;
+    std::string text;
+    long records = 0, rejected = 0;
+    int lines = rnd(200);
+
+    for(int i=0; i<lines; i++) {
+      int r = rnd(20);
+      if(r == 0) {
+        text += bad[rnd(nbad)];
+        rejected++;
+      }
+      else if(r != 1) {
+        std::string key = std::string(1, (char)('A' + rnd(3))) + "," + (char)('A' + rnd(3));
+        double price = rnd(60) / 2.0, time = rnd(60) / 2.0;
+        char field[32];
+        text += key + ",";
+        if(rnd(3) == 0)
+          text += "+";
+        snprintf(field, sizeof(field), "%g", price);
+        text += field;
+        text += rnd(4) == 0 ? std::string(rnd(2) ? 80 : 3, ' ') + "," : ",";   // a line longer than a chunk
+        snprintf(field, sizeof(field), "%g", time);
+        text += field;
+        expect[key].push_back(Opt(price, time));
+        records++;
+      }
+      // r == 1:  a blank line
+      if(i + 1 < lines || rnd(2))
+        text += rnd(3) == 0 ? "\r\n" : "\n";
+    }
+
+    FILE *in = tmpfile();
+    fwrite(text.data(), 1, text.size(), in);
+    FareIngest small(64), big;
+    rewind(in);
+    CHECK(small.ingest(in));
+    rewind(in);
+    CHECK(big.ingest(in));
+    fclose(in);
+    FareIngest mem;
+    mem.ingest_text(text.data(), text.size());
+
+    FareIngest *all[] = { &small, &big, &mem };
+    for(int k=0; k<3; k++) {
+      const FareIngest &f = *all[k];
+      CHECK(f.routes() == (int)expect.size());
+      CHECK(f.stats().records == (uint64_t)records && f.stats().rejected == (uint64_t)rejected);
+      CHECK(f.stats().bytes == text.size());
+      for(std::map<std::string, OptVec>::const_iterator e = expect.begin(); e != expect.end(); ++e) {
+        const TravelOptions *o = f.find(e->first);
+        CHECK(o != nullptr && contents(*o) == brute_pareto(e->second) && o->is_pareto_sorted());
+      }
+    }
+    CHECK(small.find("no,route") == nullptr && small.find("A", "Z") == nullptr);
+  }
+}
+
+// TravelStats:  with -DTRVL_STATS, a known sequence of operations (part of it on a thread that has exited
+// by the time of the snapshot) must give exact counts, in snapshot() and in the JSON and Prometheus
+// output, and reset() must bring everything back to zero.  Without it, everything stays zero.
+static bool all_zero(const trvl_stats::Totals &t) {
+  for(int op=0; op<trvl_stats::OPS; op++) {
+    if(t.used(op) || t.ns[op] != 0)
+      return false;
+    for(int b=0; b<trvl_stats::BUCKETS; b++) {
+      if(t.hist[op][b] != 0)
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool has(const std::string &text, const std::string &part) {
+  return text.find(part) != std::string::npos;
+}
+
+static void test_stats() {
+  using namespace trvl_stats;
+
+  reset();
+  CHECK(all_zero(snapshot()));
+
+  // 5 nodes allocated; prune_sorted visits 4 pairs and drops 3; delete frees the last 2 (under "other")
+  OptVec v;
+  v.push_back(Opt(1, 5));
+  v.push_back(Opt(1, 5));
+  v.push_back(Opt(2, 6));
+  v.push_back(Opt(3, 1));
+  v.push_back(Opt(4, 1));
+  TravelOptions *a = TravelOptions::from_vec(v);
+  CHECK(a->prune_sorted());
+  delete a;
+
+  // the same on a thread that exits before the snapshot:  3 nodes, 2 pairs, 2 dropped, 1 freed at the end
+  std::thread t([]() {
+    OptVec w;
+    w.push_back(Opt(1, 1));
+    w.push_back(Opt(2, 2));
+    w.push_back(Opt(3, 3));
+    TravelOptions *b = TravelOptions::from_vec(w);
+    b->prune_sorted();
+    delete b;
+  });
+  t.join();
+
+  Totals s = snapshot();
+#ifdef TRVL_STATS
+  CHECK(enabled());
+  CHECK(s.calls[FROM_VEC] == 2 && s.counters[FROM_VEC][NODES_ALLOCATED] == 8);
+  CHECK(s.calls[PRUNE_SORTED] == 2);
+  CHECK(s.counters[PRUNE_SORTED][NODES_VISITED] == 6 && s.counters[PRUNE_SORTED][COMPARES] == 6);
+  CHECK(s.counters[PRUNE_SORTED][PRUNED] == 5 && s.counters[PRUNE_SORTED][NODES_FREED] == 5);
+  CHECK(s.counters[OTHER][NODES_FREED] == 3 && s.counters[OTHER][NODES_ALLOCATED] == 0);
+  CHECK(!s.used(JOIN_PLUS_PLUS) && !s.used(UNION_PARETO_SORTED));
+  uint64_t in_buckets = 0;
+  for(int b=0; b<BUCKETS; b++)
+    in_buckets += s.hist[PRUNE_SORTED][b];
+  CHECK(in_buckets == 2);
+
+  std::string json = to_json(s), prom = to_prometheus(s);
+  CHECK(has(json, "{\"enabled\": true, \"ops\": ["));
+  CHECK(has(json, "{\"op\": \"from_vec\", \"calls\": 2, \"seconds\": "));
+  CHECK(has(json, "\"nodes_allocated\": 8"));
+  CHECK(has(json, "{\"op\": \"prune_sorted\", \"calls\": 2, \"seconds\": "));
+  CHECK(has(json, "\"nodes_visited\": 6, \"compares\": 6, \"nodes_allocated\": 0, \"nodes_freed\": 5, \"pruned\": 5"));
+  CHECK(has(json, "\"histogram\": [{\"le_ns\": ") && !has(json, "join_plus_plus"));
+  CHECK(has(prom, "# TYPE trvl_op_calls_total counter\n"));
+  CHECK(has(prom, "trvl_op_calls_total{op=\"from_vec\"} 2\n"));
+  CHECK(has(prom, "trvl_op_nodes_allocated_total{op=\"from_vec\"} 8\n"));
+  CHECK(has(prom, "trvl_op_pruned_total{op=\"prune_sorted\"} 5\n"));
+  CHECK(has(prom, "trvl_op_nodes_freed_total{op=\"other\"} 3\n"));
+  CHECK(has(prom, "trvl_op_seconds_bucket{op=\"prune_sorted\",le=\"+Inf\"} 2\n"));
+  CHECK(has(prom, "trvl_op_seconds_count{op=\"prune_sorted\"} 2\n") && !has(prom, "join_plus_plus"));
+
+  reset();
+  s = snapshot();
+  CHECK(all_zero(s));
+  CHECK(to_json(s) == "{\"enabled\": true, \"ops\": []}\n");
+#else
+  CHECK(!enabled() && all_zero(s));
+  CHECK(to_json(s) == "{\"enabled\": false, \"ops\": []}\n");
+  CHECK(has(to_prometheus(s), "disabled"));
+#endif
+}
+
+int main(int argc, char *argv[]){
+  unsigned seed = argc > 1 ? (unsigned)atoi(argv[1]) : 1;
+  struct Test {
+    const char *name;
+    void (*run)();
+  } tests[] = {
+    { "basics", test_basics },
+    { "join_plus_plus", test_join_plus_plus },
+    { "chains", test_chains },
+    { "union_k", test_union_k },
+    { "batch", test_batch },
+    { "queries", test_queries },
+    { "join_plus_max", test_join_plus_max },
+    { "parallel", test_parallel },
+    { "skyline", test_skyline },
+    { "epsilon", test_epsilon },
+    { "planner", test_planner },
+    { "join_view", test_join_view },
+    { "layered", test_layered },
+    { "sort", test_sort },
+    { "flat", test_flat },
+    { "dominance", test_dominance },
+    { "concurrent", test_concurrent },
+    { "frontier_file", test_frontier_file },
+    { "fare_ingest", test_fare_ingest },
+    { "stats", test_stats },
+  };
+
+  gen.seed(seed);
+  for(size_t i=0; i<sizeof(tests) / sizeof(tests[0]); i++) {
+    long before = failures;
+    tests[i].run();
+    printf("%-16s %s\n", tests[i].name, failures == before ? "ok" : "FAILED");
+  }
+  printf("%ld checks, %ld failed (seed %u)\n", checks, failures, seed);
+  return failures != 0;
+}
@@ -65,7 +65,8 @@ int main(int argc, char *argv[]){
 
   options_p3= options_p->union_pareto_sorted(*options_p2);
 
-  if(options_p3->prune_sorted())
+  // nullptr:  options_p is not sorted-pareto
+  if(options_p3 != nullptr && options_p3->prune_sorted())
      std::cout << "prune_sorted worked!" << std::endl;
 
   delete options_p3;